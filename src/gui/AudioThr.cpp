@@ -24,6 +24,7 @@
 #include <Settings.hpp>
 #include <Functions.hpp>
 #include <PlayClass.hpp>
+#include <SampleConvert.hpp>
 #include <AudioFilter.hpp>
 #include <ScreenSaver.hpp>
 #include <QMPlay2Extensions.hpp>
@@ -32,6 +33,24 @@
 
 #include <cmath>
 
+static int channelSide(int channels, int c)
+{
+	//-1 - left, 1 - right, 0 - center/LFE, order of FFmpeg default channel layouts ("av_get_default_channel_layout()")
+	static constexpr qint8 sides[8][8] = {
+		{ 0},                        //Mono: FC
+		{-1, 1},                     //Stereo: FL FR
+		{-1, 1, 0},                  //2.1: FL FR LFE
+		{-1, 1, 0, 0},               //4.0: FL FR FC BC
+		{-1, 1, 0, -1, 1},           //5.0: FL FR FC BL BR
+		{-1, 1, 0, 0, -1, 1},        //5.1: FL FR FC LFE BL BR
+		{-1, 1, 0, 0, 0, -1, 1},     //6.1: FL FR FC LFE BC SL SR
+		{-1, 1, 0, 0, -1, 1, -1, 1}, //7.1: FL FR FC LFE BL BR SL SR
+	};
+	if (channels <= 8)
+		return sides[channels - 1][c];
+	return (c & 1) ? 1 : -1;
+}
+
 AudioThr::AudioThr(PlayClass &playC, const QStringList &pluginsName) :
 	AVThread(playC, "audio:", nullptr, pluginsName)
 {
@@ -175,6 +194,7 @@ void AudioThr::run()
 	QMutex emptyBufferMutex;
 	bool paused = false;
 	bool oneFrame = false;
+	bool resamplerHasDelay = false, timeStretchHasDelay = false;
 	tmp_br = tmp_time = 0;
 #ifdef Q_OS_WIN
 	canUpdatePos = canUpdateBitrate = false;
@@ -185,7 +205,6 @@ void AudioThr::run()
 		Decoder *last_dec = dec;
 		while (!br && dec == last_dec)
 		{
-			playC.aPackets.lock();
 			const bool hasAPackets = playC.aPackets.canFetch();
 			bool hasBufferedSamples = false;
 			if (playC.endOfStream && !hasAPackets)
@@ -196,6 +215,43 @@ void AudioThr::run()
 						break;
 					}
 
+			if ((resamplerHasDelay || timeStretchHasDelay) && playC.endOfStream && !hasAPackets && !hasBufferedSamples && !playC.paused)
+			{
+				//Write samples which are still delayed inside the time stretcher and the resampler, so the end of stream is not cut off
+				mutex.lock();
+				if (!br && timeStretchHasDelay)
+				{
+					timeStretch.flush(stretchedChunk);
+					if (stretchedChunk.size() > 0)
+					{
+						stretchedData.setRawData((const char *)stretchedChunk.constData(), stretchedChunk.size());
+						if (sndResampler.isOpen())
+						{
+							sndResampler.convert(stretchedData, resampledChunk);
+							resampledData.setRawData((const char *)resampledChunk.constData(), resampledChunk.size());
+							resamplerHasDelay = true;
+							if (!resampledData.isEmpty())
+								writer->write(resampledData);
+						}
+						else
+						{
+							writer->write(stretchedData);
+						}
+					}
+				}
+				if (!br && resamplerHasDelay && sndResampler.isOpen())
+				{
+					sndResampler.flush(resampledChunk);
+					if (resampledChunk.size() > 0)
+					{
+						resampledData.setRawData((const char *)resampledChunk.constData(), resampledChunk.size());
+						writer->write(resampledData);
+					}
+				}
+				resamplerHasDelay = timeStretchHasDelay = false;
+				mutex.unlock();
+			}
+
 			if ((playC.paused && !oneFrame) || (!hasAPackets && !hasBufferedSamples) || playC.waitForData || (playC.audioSeekPos <= 0.0 && playC.videoSeekPos > 0.0))
 			{
 #ifdef Q_OS_WIN
@@ -209,7 +265,6 @@ void AudioThr::run()
 					paused = true;
 					emit pauseVisSig(paused);
 				}
-				playC.aPackets.unlock();
 
 				if (!playC.paused)
 					waiting = playC.fillBufferB = true;
@@ -230,10 +285,14 @@ void AudioThr::run()
 
 			Packet packet;
 			if (!hasBufferedSamples && (dec->pendingFrames() == 0 || flushAudio))
-				packet = playC.aPackets.fetch();
+			{
+				if (!playC.aPackets.fetch(packet))
+					continue; //Buffer has been cleared or seeked in the meantime
+			}
 			else if (hasBufferedSamples)
+			{
 				packet.ts = audio_pts + playC.audio_last_delay + delay; //szacowanie czasu
-			playC.aPackets.unlock();
+			}
 
 			if (playC.nextFrameB && playC.seekTo < 0.0 && playC.audioSeekPos <= 0.0 && playC.frame_last_pts <= 0.0)
 			{
@@ -286,6 +345,9 @@ void AudioThr::run()
 					filter->clearBuffers();
 				delay += filter->filter(decoded, hasBufferedSamples);
 			}
+			if (flushAudio)
+				timeStretch.clear();
+			delay += timeStretch.delay();
 
 			if (flushAudio)
 				playC.flushAudio = false;
@@ -295,32 +357,26 @@ void AudioThr::run()
 			{
 				const double max_len = 0.02; //TODO: zrobić opcje?
 				const int chunk = qMin(decodedSize, (int)(ceil(realSample_rate * max_len) * realChannels * sizeof(float)));
-				float vol[2] = {0.0f, 0.0f};
-				if (!playC.muted)
+				const int frames = chunk / sizeof(float) / realChannels;
+
+				float gains[SampleConvert::maxChannels];
+				bool isMuted = true;
+				for (int c = 0; c < realChannels; ++c)
 				{
-					const auto getVolume = [this](double vol) {
-						return playC.replayGain * (qFuzzyCompare(vol, 1.0) ? 1.0 : vol * vol);
-					};
-					if (realChannels == 1)
+					gains[c] = 0.0f;
+					if (!playC.muted)
 					{
-						const double monoVol = (playC.vol[0] + playC.vol[1]) / 2.0;
-						if (monoVol > 0.0)
-							vol[0] = vol[1] = getVolume(monoVol);
-					}
-					else for (int c = 0; c < 2; ++c)
-					{
-						if (playC.vol[c] > 0.0)
-							vol[c] = getVolume(playC.vol[c]);
+						const int side = channelSide(realChannels, c);
+						const double vol = (side < 0) ? playC.vol[0] : (side > 0) ? playC.vol[1] : (playC.vol[0] + playC.vol[1]) / 2.0;
+						if (vol > 0.0)
+							gains[c] = playC.replayGain * (qFuzzyCompare(vol, 1.0) ? 1.0 : vol * vol);
 					}
+					isMuted &= qFuzzyIsNull(gains[c]);
 				}
 
-				const bool isMuted = qFuzzyIsNull(vol[0]) && qFuzzyIsNull(vol[1]);
-
-				QByteArray decodedChunk;
-				if (isMuted)
-					decodedChunk.fill(0, chunk);
-				else
-					decodedChunk = QByteArray::fromRawData((const char *)decoded.constData() + decodedPos, chunk);
+				//The chunk is processed in-place, "decoded" is owned by this thread
+				float *chunkData = (float *)(decoded.data() + decodedPos);
+				const QByteArray decodedChunk = QByteArray::fromRawData((const char *)chunkData, chunk);
 
 				decodedPos += chunk;
 				decodedSize -= chunk;
@@ -370,49 +426,59 @@ void AudioThr::run()
 						lastSpeed = speed;
 					}
 
-					if (!isMuted && (!qFuzzyCompare(vol[0], 1.0f) || !qFuzzyCompare(vol[1], 1.0f)))
+					if (isMuted)
 					{
-						const int size = decodedChunk.size() / sizeof(float);
-						float *data = (float *)decodedChunk.data();
-						for (int i = 0; i < size; ++i)
-							data[i] *= vol[i & 1];
+						memset(chunkData, 0, chunk);
 					}
-
-					for (QMPlay2Extensions *vis : asConst(visualizations))
-						vis->sendSoundData(decodedChunk);
-
-					QByteArray dataToWrite;
-					if (sndResampler.isOpen())
-						sndResampler.convert(decodedChunk, dataToWrite);
-					else
-						dataToWrite = decodedChunk;
-
-					if (!isMuted && doSilence >= 0.0)
+					else if (doSilence >= 0.0)
 					{
 						silenceChMutex.lock();
 						if (doSilence >= 0.0)
 						{
-							float *data = (float *)dataToWrite.data();
-							const int s = dataToWrite.size() / sizeof(float);
-							for (int i = 0; i < s; i += channels)
-							{
-								for (int j = 0; j < channels; ++j)
-									data[i+j] *= doSilence;
-								doSilence -= silence_step;
-								if (doSilence < 0.0)
-									doSilence = 0.0;
-								else if (doSilence > 1.0)
-								{
-									doSilence = -1.0;
-									break;
-								}
-							}
+							//"silence_step" is for output frames, fade is applied before resampling
+							const double fadeStep = silence_step * sample_rate / realSample_rate / (speed > 0.0 ? speed : 1.0);
+							SampleConvert::applyGain(chunkData, frames, realChannels, gains, doSilence, fadeStep);
+							doSilence -= frames * fadeStep;
+							if (doSilence < 0.0)
+								doSilence = 0.0;
+							else if (doSilence > 1.0)
+								doSilence = -1.0;
+						}
+						else
+						{
+							SampleConvert::applyGain(chunkData, frames, realChannels, gains);
 						}
 						silenceChMutex.unlock();
 					}
+					else
+					{
+						//Also at unity gain, so samples are always clipped here regardless of the volume
+						SampleConvert::applyGain(chunkData, frames, realChannels, gains);
+					}
+
+					for (QMPlay2Extensions *vis : asConst(visualizations))
+						vis->sendSoundData(decodedChunk);
+
+					//Output buffers reuse the memory of the previous chunk, "stretchedData" and "resampledData" only point to it
+					const QByteArray *dataToWrite = &decodedChunk;
+					if (timeStretch.isActive())
+					{
+						timeStretch.process(chunkData, frames, stretchedChunk);
+						timeStretchHasDelay = true;
+						stretchedData.setRawData((const char *)stretchedChunk.constData(), stretchedChunk.size());
+						dataToWrite = &stretchedData;
+					}
+					if (sndResampler.isOpen() && !dataToWrite->isEmpty())
+					{
+						sndResampler.convert(*dataToWrite, resampledChunk);
+						resampledData.setRawData((const char *)resampledChunk.constData(), resampledChunk.size());
+						resamplerHasDelay = true;
+						dataToWrite = &resampledData;
+					}
 
 					oneFrame = false;
-					writer->write(dataToWrite);
+					if (!dataToWrite->isEmpty())
+						writer->write(*dataToWrite);
 				}
 				else
 				{
@@ -429,9 +495,15 @@ void AudioThr::run()
 bool AudioThr::resampler_create()
 {
 	const double speed = playC.speed > 0.0 ? playC.speed : 1.0;
-	if (realSample_rate != sample_rate || realChannels != channels || speed != 1.0)
+	const bool keepPitch = QMPlay2Core.getSettings().getBool("KeepAudioPitch");
+
+	timeStretch.setParams(realChannels, realSample_rate);
+	timeStretch.setSpeed(keepPitch ? speed : 1.0);
+
+	const double resamplerSpeed = keepPitch ? 1.0 : speed;
+	if (realSample_rate != sample_rate || realChannels != channels || resamplerSpeed != 1.0)
 	{
-		const bool OK = sndResampler.create(realSample_rate, realChannels, sample_rate / speed, channels);
+		const bool OK = sndResampler.create(realSample_rate, realChannels, sample_rate / resamplerSpeed, channels);
 		if (!OK)
 			QMPlay2Core.logError(tr("Error during initialization") + ": " + sndResampler.name());
 		return OK;
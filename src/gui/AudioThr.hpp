@@ -21,6 +21,8 @@
 #include <AVThread.hpp>
 
 #include <SndResampler.hpp>
+#include <TimeStretch.hpp>
+#include <Buffer.hpp>
 
 #include <QVector>
 
@@ -55,7 +57,12 @@ private:
 	void timerEvent(QTimerEvent *) override;
 #endif
 
+	TimeStretch timeStretch;
+	Buffer stretchedChunk;
+	QByteArray stretchedData;
 	SndResampler sndResampler;
+	Buffer resampledChunk;
+	QByteArray resampledData;
 	uchar realChannels, channels;
 	uint  realSample_rate, sample_rate;
 	double lastSpeed;
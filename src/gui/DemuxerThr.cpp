@@ -172,6 +172,12 @@ void DemuxerThr::seek(bool doDemuxerSeek)
 
 		if (seekInBuffer && (!localStream || !backward))
 		{
+			// Packets are fetched without locking, so stop the A/V threads first
+			if (aThr)
+				aLocked = aThr->lock();
+			if (vThr)
+				vLocked = vThr->lock();
+
 			playC.vPackets.lock();
 			playC.aPackets.lock();
 			playC.sPackets.lock();
@@ -201,13 +207,15 @@ void DemuxerThr::seek(bool doDemuxerSeek)
 				doDemuxerSeek = false;
 				flush = true;
 				ensureTrueUpdateBuffered();
-				if (aThr)
-					aLocked = aThr->lock();
-				if (vThr)
-					vLocked = vThr->lock();
 			}
 			else
 			{
+				if (aLocked)
+					aThr->unlock();
+				if (vLocked)
+					vThr->unlock();
+				aLocked = vLocked = false;
+
 				if (!accurateSeek && !backward && !localStream && playC.endOfStream)
 				{
 					// Don't seek in demuxer on network streams if we can't seek in buffer
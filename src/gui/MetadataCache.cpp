@@ -0,0 +1,198 @@
+/*
+	QMPlay2 is a video and audio player.
+	Copyright (C) 2010-2018  Błażej Szczygieł
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU Lesser General Public License as published
+	by the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <MetadataCache.hpp>
+
+#include <QMPlay2Core.hpp>
+#include <Settings.hpp>
+#include <Module.hpp>
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QFile>
+
+static constexpr quint32 g_magic = 0x514D4D43; //"QMMC"
+static constexpr quint32 g_version = 2;
+static constexpr int g_maxEntries = 100000; //Entries not used in current session are dropped above this
+
+static bool getFileStamp(const QString &filePath, qint64 &size, qint64 &mTime)
+{
+	const QFileInfo fileInfo(filePath);
+	if (!fileInfo.isFile())
+		return false;
+	size = fileInfo.size();
+	mTime = fileInfo.lastModified().toMSecsSinceEpoch();
+	return true;
+}
+
+//Values of settings which change titles or lengths returned by demuxers
+static QByteArray getSettingsStamp()
+{
+	QByteArray stamp;
+	QDataStream stream(&stamp, QIODevice::WriteOnly);
+	Settings &QMPSettings = QMPlay2Core.getSettings();
+	stream << QMPSettings.getBool("DisplayOnlyFileName") << QMPSettings.getBool("HideArtistMetadata");
+	for (Module *module : QMPlay2Core.getPluginsInstance())
+	{
+		if (module->name() == "Chiptune")
+			stream << module->getInt("DefaultLength");
+	}
+	return stamp;
+}
+
+/**/
+
+MetadataCache::MetadataCache() :
+	m_cacheFilePath(QMPlay2Core.getSettingsDir() + "MetadataCache.bin")
+{}
+MetadataCache::~MetadataCache()
+{
+	save();
+}
+
+void MetadataCache::checkSettings()
+{
+	const QByteArray settingsStamp = getSettingsStamp();
+
+	QMutexLocker locker(&m_mutex);
+	if (m_settingsStamp == settingsStamp)
+		return;
+	m_settingsStamp = settingsStamp;
+	if (m_loaded && !m_entries.isEmpty())
+	{
+		m_entries.clear();
+		m_modified = true;
+	}
+}
+
+bool MetadataCache::get(const QString &filePath, Data &data)
+{
+	qint64 size, mTime;
+	if (!getFileStamp(filePath, size, mTime))
+		return false;
+
+	QMutexLocker locker(&m_mutex);
+	load();
+	auto it = m_entries.find(filePath);
+	if (it == m_entries.end())
+		return false;
+	if (it->size != size || it->mTime != mTime)
+	{
+		m_entries.erase(it);
+		m_modified = true;
+		return false;
+	}
+	it->used = true;
+	data = it->data;
+	return true;
+}
+void MetadataCache::insert(const QString &filePath, const Data &data)
+{
+	qint64 size, mTime;
+	if (!getFileStamp(filePath, size, mTime))
+		return;
+
+	QMutexLocker locker(&m_mutex);
+	load();
+	m_entries[filePath] = {size, mTime, data, true};
+	m_modified = true;
+}
+
+void MetadataCache::save()
+{
+	QMutexLocker locker(&m_mutex);
+	if (!m_modified)
+		return;
+
+	if (m_entries.count() > g_maxEntries)
+	{
+		for (auto it = m_entries.begin(); it != m_entries.end();)
+		{
+			if (!it->used)
+				it = m_entries.erase(it);
+			else
+				++it;
+		}
+	}
+
+	QSaveFile file(m_cacheFilePath);
+	if (!file.open(QFile::WriteOnly))
+		return;
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_6);
+	stream << g_magic << g_version << m_settingsStamp << (quint32)m_entries.count();
+	for (auto it = m_entries.constBegin(), itEnd = m_entries.constEnd(); it != itEnd; ++it)
+	{
+		const Data &data = it->data;
+		stream << it.key() << it->size << it->mTime << data.title << data.length << (quint32)data.tracks.count();
+		for (const Playlist::Entry &track : data.tracks)
+			stream << track.url << track.name << track.length << track.GID << track.parent;
+	}
+
+	if (stream.status() == QDataStream::Ok && file.commit())
+		m_modified = false;
+}
+
+void MetadataCache::load()
+{
+	if (m_loaded)
+		return;
+	m_loaded = true;
+
+	QFile file(m_cacheFilePath);
+	if (!file.open(QFile::ReadOnly))
+		return;
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_6);
+
+	quint32 magic = 0, version = 0;
+	stream >> magic >> version;
+	if (magic != g_magic || version != g_version)
+		return;
+
+	QByteArray settingsStamp;
+	quint32 count = 0;
+	stream >> settingsStamp >> count;
+	if (stream.status() != QDataStream::Ok || settingsStamp != m_settingsStamp)
+	{
+		m_modified = true; //Overwrite outdated entries
+		return;
+	}
+
+	m_entries.reserve(qMin<quint32>(count, g_maxEntries));
+	for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+	{
+		QString filePath;
+		Entry entry;
+		quint32 tracksCount = 0;
+		stream >> filePath >> entry.size >> entry.mTime >> entry.data.title >> entry.data.length >> tracksCount;
+		for (quint32 t = 0; t < tracksCount && stream.status() == QDataStream::Ok; ++t)
+		{
+			Playlist::Entry track;
+			stream >> track.url >> track.name >> track.length >> track.GID >> track.parent;
+			entry.data.tracks += track;
+		}
+		entry.used = false;
+		if (stream.status() == QDataStream::Ok)
+			m_entries.insert(filePath, entry);
+	}
+}
@@ -0,0 +1,68 @@
+/*
+	QMPlay2 is a video and audio player.
+	Copyright (C) 2010-2018  Błażej Szczygieł
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU Lesser General Public License as published
+	by the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <Playlist.hpp>
+
+#include <QMutex>
+#include <QHash>
+
+/*
+ * Probe results of local files (title, length and tracks) stored on disk between sessions.
+ * An entry is valid only while the file has the same size and modification time, all entries
+ * are dropped when settings which change titles or lengths are changed.
+ */
+class MetadataCache
+{
+	Q_DISABLE_COPY(MetadataCache)
+
+public:
+	struct Data
+	{
+		QString title;
+		double length = -1.0;
+		Playlist::Entries tracks;
+	};
+
+	MetadataCache();
+	~MetadataCache();
+
+	//Thread-safe
+	void checkSettings(); //Must be called before "get()" and "insert()" to use the current settings
+	bool get(const QString &filePath, Data &data);
+	void insert(const QString &filePath, const Data &data);
+
+	void save(); //Writes the file, the GUI thread should use it only on exit
+
+private:
+	void load();
+
+	struct Entry
+	{
+		qint64 size, mTime;
+		Data data;
+		bool used;
+	};
+
+	const QString m_cacheFilePath;
+	QMutex m_mutex;
+	QByteArray m_settingsStamp;
+	QHash<QString, Entry> m_entries;
+	bool m_loaded = false, m_modified = false;
+};
@@ -380,6 +380,7 @@ void PlayClass::loadSubsFile(const QString &fileName)
 
 			sPackets.clear();
 			subsMutex.lock();
+			assMutex.lock();
 
 			vThr->destroySubtitlesDecoder();
 			if (!QMPlay2Core.getSettings().getBool("KeepSubtitlesDelay"))
@@ -435,6 +436,7 @@ void PlayClass::loadSubsFile(const QString &fileName)
 				ass->closeASS();
 			}
 
+			assMutex.unlock();
 			subsMutex.unlock();
 		}
 	}
@@ -487,8 +489,14 @@ inline double PlayClass::getSAR()
 void PlayClass::flushAssEvents()
 {
 	subsMutex.lock();
+	if (vThr)
+		vThr->discardPendingSubtitles();
 	if (ass && subtitlesStream > -1)
+	{
+		assMutex.lock();
 		ass->flushASSEvents();
+		assMutex.unlock();
+	}
 	subsMutex.unlock();
 }
 void PlayClass::clearSubtitlesBuffer()
@@ -1099,11 +1107,13 @@ void PlayClass::aRatioUpdated(double sar) //jeżeli współczynnik proporcji zmi
 		const double aspect_ratio = getARatio();
 		if (ass)
 			ass->setARatio(aspect_ratio);
-		vThr->lock();
-		vThr->setDeleteOSD();
-		vThr->setARatio(aspect_ratio, getSAR());
-		vThr->processParams();
-		vThr->unlock();
+		if (vThr->lock())
+		{
+			vThr->setDeleteOSD();
+			vThr->setARatio(aspect_ratio, getSAR());
+			vThr->processParams();
+			vThr->unlock();
+		}
 		demuxThr->emitInfo();
 	}
 }
@@ -1469,9 +1479,11 @@ void PlayClass::load(Demuxer *demuxer)
 		if (videoStream >= 0 && vThr)
 		{
 			subsMutex.lock();
+			assMutex.lock();
 			vThr->destroySubtitlesDecoder();
 			ass->closeASS();
 			ass->clearFonts();
+			assMutex.unlock();
 			subsMutex.unlock();
 
 			if (subtitlesEnabled && fileSubsList.count() && chosenSubtitlesStream < 0)
@@ -1490,6 +1502,7 @@ void PlayClass::load(Demuxer *demuxer)
 					if (subtitlesSync < 0.0)
 						subtitlesSync = 0.0;
 					subsMutex.lock();
+					assMutex.lock();
 					if (dec)
 						vThr->setSubtitlesDecoder(dec);
 					QByteArray assHeader = streams[subtitlesStream]->data;
@@ -1507,6 +1520,7 @@ void PlayClass::load(Demuxer *demuxer)
 						seekTo = SEEK_STREAM_RELOAD;
 						allowAccurateSeek = true;
 					}
+					assMutex.unlock();
 					subsMutex.unlock();
 				}
 				else
@@ -158,6 +158,7 @@ private:
 	LibASS *ass;
 
 	QMutex osdMutex, subsMutex;
+	QMutex assMutex; //Guards "ass" subtitles track, locked after "subsMutex", "VideoThr" only tries to lock it
 	QMPlay2OSD *osd;
 	int videoWinW, videoWinH;
 	QStringList fileSubsList;
@@ -24,6 +24,7 @@
 #include <Reader.hpp>
 #include <Main.hpp>
 
+#include <QWaitCondition>
 #include <QResizeEvent>
 #include <QHeaderView>
 #include <QFileInfo>
@@ -33,6 +34,8 @@
 #include <QMenu>
 #include <QDir>
 
+#include <memory>
+
 static inline QStringList getDirEntries(const QString &pth)
 {
 	return QDir(pth).entryList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name | QDir::DirsFirst);
@@ -71,6 +74,194 @@ public:
 	}
 };
 
+/* EntryProber class */
+struct ProbedEntry
+{
+	inline ProbedEntry(bool onlyTracks = false) :
+		fetchTracks(onlyTracks)
+	{}
+
+	QString url, name;
+	double length = -1.0;
+	Demuxer::FetchTracks fetchTracks;
+	bool created = false;
+};
+
+static void probeEntry(ProbedEntry &pe, IOController<> &ioCtrl, MetadataCache &metadataCache, const Functions::DemuxersInfo &demuxersInfo, bool getRealUrl, bool displayOnlyFileName)
+{
+	if (getRealUrl) //Don't try to get the real address from extension plugin when only tracks are needed
+		Functions::getDataIfHasPluginPrefix(pe.url, &pe.url, &pe.name, nullptr, &ioCtrl, demuxersInfo);
+
+	const QString filePath = (!pe.fetchTracks.onlyTracks && pe.url.startsWith("file://")) ? pe.url.mid(7) : QString();
+	MetadataCache::Data data;
+	if (!filePath.isEmpty() && metadataCache.get(filePath, data))
+	{
+		pe.created = true;
+	}
+	else
+	{
+		IOController<Demuxer> &demuxer = ioCtrl.toRef<Demuxer>();
+		if (!Demuxer::create(pe.url, demuxer, &pe.fetchTracks))
+			return;
+		data.tracks = pe.fetchTracks.tracks;
+		if (demuxer)
+		{
+			data.title = demuxer->title();
+			data.length = demuxer->length();
+		}
+		if (!filePath.isEmpty())
+			metadataCache.insert(filePath, data);
+		pe.created = true;
+		demuxer.reset();
+	}
+
+	pe.fetchTracks.tracks = data.tracks;
+	if (pe.fetchTracks.tracks.isEmpty())
+	{
+		if (!displayOnlyFileName && pe.name.isEmpty())
+			pe.name = data.title;
+		pe.length = data.length;
+	}
+}
+
+/*
+ * Probes entries of a single "AddThr::add()" call in the thread pool, a few entries ahead of the
+ * entry which is currently added. Results are taken in the order of entries, so the first entries
+ * (visible at the top) are ready first. Pending probes are dropped when the prober is destroyed.
+ */
+class EntryProber
+{
+	Q_DISABLE_COPY(EntryProber)
+
+	enum Status : quint8 {Pending, Probed, Skipped};
+
+	struct State
+	{
+		QMutex mutex;
+		QWaitCondition cond;
+		bool aborted = false;
+
+		QStringList urls, playlistExtensions;
+		MetadataCache *metadataCache;
+		Functions::DemuxersInfo demuxersInfo;
+		bool displayOnlyFileName;
+
+		QVector<ProbedEntry> entries;
+		QVector<Status> status;
+		QList<IOController<> *> ioCtrls;
+	};
+	using StatePtr = std::shared_ptr<State>;
+
+	class Task final : public QRunnable
+	{
+	public:
+		inline Task(const StatePtr &state, int idx) :
+			m_state(state),
+			m_idx(idx)
+		{}
+
+	private:
+		void run() override
+		{
+			State &state = *m_state;
+
+			const QString url = Functions::Url(state.urls.at(m_idx));
+			const QString dUrl = url.startsWith("file://") ? url.mid(7) : QString();
+			if (state.playlistExtensions.contains(Functions::fileExt(url).toLower()) || QFileInfo(dUrl).isDir())
+			{
+				finish(Skipped, ProbedEntry());
+				return;
+			}
+
+			IOController<> ioCtrl;
+			{
+				QMutexLocker locker(&state.mutex);
+				if (state.aborted)
+					return;
+				state.ioCtrls += &ioCtrl;
+			}
+
+			ProbedEntry pe;
+			pe.url = url;
+			probeEntry(pe, ioCtrl, *state.metadataCache, state.demuxersInfo, true, state.displayOnlyFileName);
+
+			QMutexLocker locker(&state.mutex);
+			state.ioCtrls.removeOne(&ioCtrl);
+			locker.unlock();
+
+			finish(ioCtrl.isAborted() ? Skipped : Probed, std::move(pe));
+		}
+
+		void finish(Status status, ProbedEntry &&pe)
+		{
+			QMutexLocker locker(&m_state->mutex);
+			m_state->entries[m_idx] = std::move(pe);
+			m_state->status[m_idx] = status;
+			m_state->cond.wakeAll();
+		}
+
+		const StatePtr m_state;
+		const int m_idx;
+	};
+
+public:
+	EntryProber(AddThr &addThr, const QStringList &urls, const Functions::DemuxersInfo &demuxersInfo, bool displayOnlyFileName) :
+		m_addThr(addThr),
+		m_state(std::make_shared<State>()),
+		m_window(addThr.probePool.maxThreadCount() * 2)
+	{
+		m_state->urls = urls;
+		m_state->playlistExtensions = Playlist::extensions();
+		m_state->metadataCache = &addThr.metadataCache;
+		m_state->demuxersInfo = demuxersInfo;
+		m_state->displayOnlyFileName = displayOnlyFileName;
+		m_state->entries.resize(urls.count());
+		m_state->status.fill(Pending, urls.count());
+
+		QMutexLocker locker(&m_addThr.probersMutex);
+		m_addThr.probers += this;
+		if (m_addThr.ioCtrl.isAborted())
+			m_state->aborted = true;
+	}
+	~EntryProber()
+	{
+		m_addThr.probersMutex.lock();
+		m_addThr.probers.removeOne(this);
+		m_addThr.probersMutex.unlock();
+		abort(); //Running tasks finish on their own, they share the state
+	}
+
+	//Returns false if the entry is not probed (directory, playlist or aborted)
+	bool take(int idx, ProbedEntry &pe)
+	{
+		for (const int end = qMin(idx + m_window, m_state->urls.count()); m_started < end; ++m_started)
+			m_addThr.probePool.start(new Task(m_state, m_started), -m_started);
+
+		QMutexLocker locker(&m_state->mutex);
+		while (m_state->status.at(idx) == Pending && !m_state->aborted)
+			m_state->cond.wait(&m_state->mutex);
+		if (m_state->status.at(idx) != Probed)
+			return false;
+		pe = std::move(m_state->entries[idx]);
+		return true;
+	}
+
+	void abort()
+	{
+		QMutexLocker locker(&m_state->mutex);
+		m_state->aborted = true;
+		for (IOController<> *ioCtrl : qAsConst(m_state->ioCtrls))
+			ioCtrl->abort();
+		m_state->cond.wakeAll();
+	}
+
+private:
+	AddThr &m_addThr;
+	const StatePtr m_state;
+	const int m_window;
+	int m_started = 0;
+};
+
 /* UpdateEntryThr class */
 UpdateEntryThr::UpdateEntryThr(PlaylistWidget &pLW) :
 	pendingUpdates(0),
@@ -201,6 +392,7 @@ AddThr::AddThr(PlaylistWidget &pLW) :
 	pLW(pLW),
 	inProgress(false)
 {
+	probePool.setMaxThreadCount(qBound(2, QThread::idealThreadCount(), 8));
 	connect(this, SIGNAL(finished()), this, SLOT(finished()));
 }
 
@@ -271,6 +463,10 @@ void AddThr::stop()
 		pLW.enqueuedAddData.clear();
 	}
 	ioCtrl.abort();
+	probersMutex.lock();
+	for (EntryProber *prober : qAsConst(probers))
+		prober->abort();
+	probersMutex.unlock();
 	wait(TERMINATE_TIMEOUT);
 	if (isRunning())
 	{
@@ -303,9 +499,12 @@ void AddThr::run()
 		for (const Module::Info &mod : module->getModulesInfo())
 			if (mod.type == Module::DEMUXER)
 				demuxersInfo += {mod.name, mod.icon.isNull() ? module->icon() : mod.icon, mod.extensions};
+	metadataCache.checkSettings();
 	add(urls, par, demuxersInfo, existingEntries.isEmpty() ? nullptr : &existingEntries, loadList);
 	if (currentThread() == pLW.thread()) //jeżeli funkcja działa w głównym wątku
-		finished();
+		finished(); //Metadata cache will be saved on exit
+	else
+		metadataCache.save();
 }
 
 bool AddThr::add(const QStringList &urls, QTreeWidgetItem *parent, const Functions::DemuxersInfo &demuxersInfo, QStringList *existingEntries, bool loadList)
@@ -313,6 +512,9 @@ bool AddThr::add(const QStringList &urls, QTreeWidgetItem *parent, const Functio
 	const bool displayOnlyFileName = QMPlay2Core.getSettings().getBool("DisplayOnlyFileName");
 	QTreeWidgetItem *currentItem = parent;
 	bool added = false;
+	std::unique_ptr<EntryProber> prober;
+	if (!loadList && sync != FILE_SYNC && !pLW.dontUpdateAfterAdd && urls.size() > 1)
+		prober.reset(new EntryProber(*this, urls, demuxersInfo, displayOnlyFileName));
 	for (int i = 0; i < urls.size(); ++i)
 	{
 		if (ioCtrl.isAborted())
@@ -406,21 +608,23 @@ bool AddThr::add(const QStringList &urls, QTreeWidgetItem *parent, const Functio
 				Playlist::Entry entry;
 				entry.url = url;
 
-				if (!pLW.dontUpdateAfterAdd) //Don't try to get the real address from extension plugin in this case (no needed for tracks)
-					Functions::getDataIfHasPluginPrefix(url, &url, &entry.name, nullptr, &ioCtrl, demuxersInfo);
-				IOController<Demuxer> &demuxer = ioCtrl.toRef<Demuxer>();
-				Demuxer::FetchTracks fetchTracks(pLW.dontUpdateAfterAdd);
-				if (Demuxer::create(url, demuxer, &fetchTracks))
+				ProbedEntry probed(pLW.dontUpdateAfterAdd);
+				if (!prober || !prober->take(i, probed))
+				{
+					probed.url = url;
+					probeEntry(probed, ioCtrl, metadataCache, demuxersInfo, !pLW.dontUpdateAfterAdd, displayOnlyFileName);
+				}
+				url = probed.url;
+				entry.name = probed.name;
+				entry.length = probed.length;
+
+				const Demuxer::FetchTracks &fetchTracks = probed.fetchTracks;
+				if (probed.created)
 				{
 					if (sync == FILE_SYNC && fetchTracks.tracks.count() <= 1)
 						hasOneEntry = false; //Don't allow adding single file when syncing a file group
 					else if (fetchTracks.tracks.isEmpty())
-					{
-						if (!displayOnlyFileName && entry.name.isEmpty())
-							entry.name = demuxer->title();
-						entry.length = demuxer->length();
 						hasOneEntry = true;
-					}
 					else
 					{
 						QTreeWidgetItem *tmpFirstItem = insertPlaylistEntries(fetchTracks.tracks, currentItem, demuxersInfo, insertChildAt, existingEntries);
@@ -429,7 +633,6 @@ bool AddThr::add(const QStringList &urls, QTreeWidgetItem *parent, const Functio
 						hasOneEntry = false;
 						tracksAdded = true;
 					}
-					demuxer.reset();
 				}
 				else if (!fetchTracks.isOK)
 					hasOneEntry = false; //Don't add entry to list if error occured
@@ -906,7 +1109,7 @@ QTreeWidgetItem *PlaylistWidget::newGroup(const QString &name, const QString &ur
 	if (existingEntries)
 		entryCreated(url, insertChildAt, *existingEntries);
 
-	QMetaObject::invokeMethod(this, "insertItem", Q_ARG(QTreeWidgetItem *, tWI), Q_ARG(QTreeWidgetItem *, parent), Q_ARG(int, insertChildAt));
+	queueInsertItem(tWI, parent, insertChildAt);
 	return tWI;
 }
 QTreeWidgetItem *PlaylistWidget::newEntry(const Playlist::Entry &entry, QTreeWidgetItem *parent, const Functions::DemuxersInfo &demuxersInfo, int insertChildAt, QStringList *existingEntries)
@@ -926,7 +1129,7 @@ QTreeWidgetItem *PlaylistWidget::newEntry(const Playlist::Entry &entry, QTreeWid
 	if (existingEntries)
 		entryCreated(entry.url, insertChildAt, *existingEntries);
 
-	QMetaObject::invokeMethod(this, "insertItem", Q_ARG(QTreeWidgetItem *, tWI), Q_ARG(QTreeWidgetItem *, parent), Q_ARG(int, insertChildAt));
+	queueInsertItem(tWI, parent, insertChildAt);
 	return tWI;
 }
 
@@ -945,6 +1148,20 @@ void PlaylistWidget::setEntryIcon(const QIcon &icon, QTreeWidgetItem *tWI)
 	}
 }
 
+void PlaylistWidget::queueInsertItem(QTreeWidgetItem *tWI, QTreeWidgetItem *parent, int insertChildAt)
+{
+	if (QThread::currentThread() == thread())
+	{
+		insertItems(); //Keep the order with items from other threads
+		insertItem(tWI, parent, insertChildAt);
+		return;
+	}
+	QMutexLocker locker(&itemsToInsertMutex);
+	if (itemsToInsert.isEmpty())
+		QMetaObject::invokeMethod(this, "insertItems", Qt::QueuedConnection);
+	itemsToInsert.append({tWI, parent, insertChildAt});
+}
+
 void PlaylistWidget::quickSyncScanDirs(const QString &pth, QTreeWidgetItem *par, bool &mustRefresh, bool recursive, QTreeWidgetItem *&itemToNull)
 {
 	QStringList dirEntries = getDirEntries(pth);
@@ -1141,6 +1358,15 @@ void PlaylistWidget::insertItem(QTreeWidgetItem *tWI, QTreeWidgetItem *parent, i
 		addTopLevelItem(tWI);
 	}
 }
+void PlaylistWidget::insertItems()
+{
+	QVector<ItemToInsert> items;
+	itemsToInsertMutex.lock();
+	items.swap(itemsToInsert);
+	itemsToInsertMutex.unlock();
+	for (const ItemToInsert &iti : qAsConst(items))
+		insertItem(iti.item, iti.parent, iti.insertChildAt);
+}
 void PlaylistWidget::popupContextMenu(const QPoint &p)
 {
 	playlistMenu()->popup(mapToGlobal(p));
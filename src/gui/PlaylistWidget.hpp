@@ -18,13 +18,16 @@
 
 #pragma once
 
+#include <MetadataCache.hpp>
 #include <IOController.hpp>
 #include <Functions.hpp>
 #include <Playlist.hpp>
 
 #include <QTreeWidget>
+#include <QThreadPool>
 #include <QAtomicInt>
 #include <QThread>
+#include <QVector>
 #include <QQueue>
 #include <QMutex>
 #include <QTimer>
@@ -32,6 +35,7 @@
 
 class QTreeWidgetItem;
 class PlaylistWidget;
+class EntryProber;
 class Demuxer;
 
 class UpdateEntryThr final : public QThread
@@ -86,6 +90,7 @@ private slots:
 
 class AddThr final : public QThread
 {
+	friend class EntryProber;
 	Q_OBJECT
 public:
 	enum SYNC {NO_SYNC = 0, DIR_SYNC = 1, FILE_SYNC = 2};
@@ -114,6 +119,11 @@ private:
 	IOController<> ioCtrl;
 	QTreeWidgetItem *firstItem, *lastItem;
 	bool inProgress;
+
+	MetadataCache metadataCache;
+	QThreadPool probePool; //Probes entries ahead of "add()"
+	QMutex probersMutex;
+	QList<EntryProber *> probers;
 private slots:
 	void finished();
 signals:
@@ -192,6 +202,9 @@ private:
 
 	void setEntryIcon(const QIcon &icon, QTreeWidgetItem *);
 
+	void queueInsertItem(QTreeWidgetItem *tWI, QTreeWidgetItem *parent, int insertChildAt);
+	void insertItem(QTreeWidgetItem *tWI, QTreeWidgetItem *parent, int insertChildAt);
+
 	void quickSyncScanDirs(const QString &pth, QTreeWidgetItem *par, bool &mustRefresh, bool recursive, QTreeWidgetItem *&itemToNull);
 
 	void createExtensionsMenu();
@@ -215,11 +228,18 @@ private:
 		bool loadList;
 	};
 	QQueue<AddData> enqueuedAddData;
+	struct ItemToInsert
+	{
+		QTreeWidgetItem *item, *parent;
+		int insertChildAt;
+	};
+	QVector<ItemToInsert> itemsToInsert; //Items created in other threads are inserted in batches
+	QMutex itemsToInsertMutex;
 	QTimer animationTimer, addTimer;
 	bool repaintAll;
 	int rotation;
 private slots:
-	void insertItem(QTreeWidgetItem *, QTreeWidgetItem *, int insertChildAt);
+	void insertItems();
 	void popupContextMenu(const QPoint &);
 	void setItemIcon(QTreeWidgetItem *, const QIcon &icon);
 	void animationUpdate();
@@ -105,6 +105,8 @@ public:
 	DeintSettingsW *deintSettingsW;
 	QGroupBox *videoEqContainer;
 	OtherVFiltersW *otherVFiltersW;
+	QSpinBox *filtersQueueDepthB;
+	QSpinBox *decodeAheadB;
 };
 
 template<typename TextWidget>
@@ -162,6 +164,8 @@ void SettingsWidget::InitSettings()
 	QMPSettings.init("LongSeek", 30);
 	QMPSettings.init("AVBufferLocal", 100);
 	QMPSettings.init("AVBufferNetwork", 50000);
+	QMPSettings.init("VideoFiltersQueueDepth", 1);
+	QMPSettings.init("VideoDecodeAhead", 4);
 	QMPSettings.init("BackwardBuffer", 1);
 	QMPSettings.init("PlayIfBuffered", 1.75);
 	QMPSettings.init("MaxVol", 100);
@@ -189,6 +193,7 @@ void SettingsWidget::InitSettings()
 	QMPSettings.init("KeepSubtitlesScale", false);
 	QMPSettings.init("KeepVideoDelay", false);
 	QMPSettings.init("KeepSpeed", false);
+	QMPSettings.init("KeepAudioPitch", true);
 	QMPSettings.init("SyncVtoA", true);
 	QMPSettings.init("Silence", true);
 	QMPSettings.init("RestoreVideoEqualizer", false);
@@ -474,6 +479,7 @@ SettingsWidget::SettingsWidget(int page, const QString &moduleName, QWidget *vid
 		page2->keepSubtitlesScale->setChecked(QMPSettings.getBool("KeepSubtitlesScale"));
 		page2->keepVideoDelay->setChecked(QMPSettings.getBool("KeepVideoDelay"));
 		page2->keepSpeed->setChecked(QMPSettings.getBool("KeepSpeed"));
+		page2->keepAudioPitch->setChecked(QMPSettings.getBool("KeepAudioPitch"));
 		page2->syncVtoA->setChecked(QMPSettings.getBool("SyncVtoA"));
 		page2->silence->setChecked(QMPSettings.getBool("Silence"));
 		page2->restoreVideoEq->setChecked(QMPSettings.getBool("RestoreVideoEqualizer"));
@@ -640,6 +646,22 @@ SettingsWidget::SettingsWidget(int page, const QString &moduleName, QWidget *vid
 			layout->addWidget(otherHWVFiltersContainer, 2, 1, 1, 1);
 		}
 
+		page6->filtersQueueDepthB = new QSpinBox;
+		page6->filtersQueueDepthB->setRange(1, 16);
+		page6->filtersQueueDepthB->setValue(QMPSettings.getInt("VideoFiltersQueueDepth"));
+		page6->filtersQueueDepthB->setToolTip(tr("Number of frames which can wait for every software video filter. Every filter runs in its own thread."));
+
+		page6->decodeAheadB = new QSpinBox;
+		page6->decodeAheadB->setRange(0, 16);
+		page6->decodeAheadB->setValue(QMPSettings.getInt("VideoDecodeAhead"));
+		page6->decodeAheadB->setSpecialValueText(tr("Disabled"));
+		page6->decodeAheadB->setToolTip(tr("Number of frames which can be decoded ahead in a separate thread. It is not used with hardware accelerated decoding."));
+
+		QFormLayout *filtersQueueDepthLayout = new QFormLayout;
+		filtersQueueDepthLayout->addRow(tr("Software video filters queue depth") + ": ", page6->filtersQueueDepthB);
+		filtersQueueDepthLayout->addRow(tr("Decoded video frames queue size") + ": ", page6->decodeAheadB);
+		layout->addLayout(filtersQueueDepthLayout, 3, 0, 1, 2);
+
 		page6->setWidget(widget);
 	}
 
@@ -842,6 +864,7 @@ void SettingsWidget::apply()
 			QMPSettings.set("KeepSubtitlesScale", page2->keepSubtitlesScale->isChecked());
 			QMPSettings.set("KeepVideoDelay", page2->keepVideoDelay->isChecked());
 			QMPSettings.set("KeepSpeed", page2->keepSpeed->isChecked());
+			QMPSettings.set("KeepAudioPitch", page2->keepAudioPitch->isChecked());
 			QMPSettings.set("SyncVtoA", page2->syncVtoA->isChecked());
 			QMPSettings.set("Silence", page2->silence->isChecked());
 			QMPSettings.set("RestoreVideoEqualizer", page2->restoreVideoEq->isChecked());
@@ -895,6 +918,8 @@ void SettingsWidget::apply()
 			page6->deintSettingsW->writeSettings();
 			if (page6->otherVFiltersW)
 				page6->otherVFiltersW->writeSettings();
+			QMPSettings.set("VideoFiltersQueueDepth", page6->filtersQueueDepthB->value());
+			QMPSettings.set("VideoDecodeAhead", page6->decodeAheadB->value());
 			break;
 	}
 	if (page != 3)
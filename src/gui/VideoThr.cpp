@@ -34,12 +34,300 @@
 #include <Functions.hpp>
 using Functions::gettime;
 
+#include <QWaitCondition>
 #include <QDebug>
 #include <QImage>
+#include <QQueue>
 #include <QDir>
 
 #include <cmath>
 
+static bool tryLockBounded(QMutex &mutex)
+{
+	if (mutex.tryLock(MUTEXWAIT_TIMEOUT))
+		return true;
+	emit QMPlay2Core.waitCursor();
+	const bool ret = mutex.tryLock(MUTEXWAIT_TIMEOUT * 2);
+	emit QMPlay2Core.restoreCursor();
+	return ret;
+}
+
+/* Decodes video packets ahead of the presentation time */
+
+class VideoDecodeAheadThr final : public QThread
+{
+public:
+	VideoDecodeAheadThr(VideoThr &videoThr, int queueSize) :
+		videoThr(videoThr),
+		queueSize(queueSize),
+		br(false)
+	{
+		setObjectName("VideoDecodeAheadThr");
+		start();
+	}
+
+	void requestStop()
+	{
+		QMutexLocker locker(&mutex);
+		br = true;
+		cond.wakeAll();
+		videoThr.playC.emptyBufferCond.wakeAll();
+	}
+
+	bool hasFrames()
+	{
+		QMutexLocker locker(&mutex);
+		return !queue.isEmpty();
+	}
+	bool take(VideoThr::Decoded &decoded)
+	{
+		QMutexLocker locker(&mutex);
+		if (queue.isEmpty())
+			return false;
+		decoded = queue.dequeue();
+		cond.wakeOne();
+		return true;
+	}
+	void clear()
+	{
+		QMutexLocker locker(&mutex);
+		queue.clear();
+		cond.wakeOne();
+	}
+
+private:
+	void run() override
+	{
+		PlayClass &playC = videoThr.playC;
+		QMutex emptyBufferMutex;
+		bool maybeFlush = false, err = false;
+		while (!br)
+		{
+			mutex.lock();
+			while (!br && queue.count() >= queueSize)
+				cond.wait(&mutex);
+			mutex.unlock();
+
+			bool hasDecoded = false;
+
+			// "VideoThr::lock()" holds this mutex, so decoder can't be changed or flushed while decoding
+			videoThr.decodeMutex.lock();
+			if (!br && videoThr.dec && !videoThr.decoderError && !playC.waitForData)
+			{
+				const bool hasVPackets = playC.vPackets.canFetch();
+				if (maybeFlush || (!videoThr.gotFrameOrError && !err))
+					maybeFlush = playC.endOfStream && !hasVPackets;
+
+				Packet packet;
+				if (hasVPackets)
+				{
+					hasDecoded = playC.vPackets.fetch(packet);
+				}
+				else if (maybeFlush)
+				{
+					packet.ts.setInvalid();
+					hasDecoded = true;
+				}
+
+				if (hasDecoded)
+				{
+					playC.fillBufferB = true;
+
+					VideoThr::Decoded decoded;
+					videoThr.decodePacket(packet, decoded);
+					maybeFlush = decoded.packet.ts.isValid();
+					err = (decoded.bytesConsumed < 0);
+
+					mutex.lock();
+					const bool wasEmpty = queue.isEmpty();
+					queue.enqueue(decoded);
+					mutex.unlock();
+					if (wasEmpty)
+						playC.emptyBufferCond.wakeAll();
+				}
+			}
+			videoThr.decodeMutex.unlock();
+
+			if (!hasDecoded && !br)
+			{
+				emptyBufferMutex.lock();
+				playC.emptyBufferCond.wait(&emptyBufferMutex, MUTEXWAIT_TIMEOUT);
+				emptyBufferMutex.unlock();
+			}
+		}
+	}
+
+	VideoThr &videoThr;
+	const int queueSize;
+
+	QQueue<VideoThr::Decoded> queue;
+	QWaitCondition cond;
+	QMutex mutex;
+	volatile bool br;
+};
+
+/* Renders ASS subtitles for the next frames ahead of the presentation time */
+
+constexpr int g_subsRenderAhead = 4;
+constexpr double g_subsPtsTolerance = 0.001;
+
+class SubtitlesRenderThr final : public QThread
+{
+	struct Rendered
+	{
+		double pts;
+		quint32 revision;
+		QMPlay2OSD *osd; //"nullptr" if there are no subtitles for this time stamp
+	};
+
+public:
+	SubtitlesRenderThr(VideoThr &videoThr) :
+		videoThr(videoThr),
+		lastOSD(nullptr),
+		lastPts(-1.0), step(0.0),
+		br(false)
+	{
+		setObjectName("SubtitlesRenderThr");
+		start();
+	}
+	~SubtitlesRenderThr()
+	{
+		for (const Rendered &r : qAsConst(rendered))
+			delete r.osd;
+		delete lastOSD;
+	}
+
+	void requestStop()
+	{
+		QMutexLocker locker(&mutex);
+		br = true;
+		cond.wakeAll();
+	}
+
+	// "subsMutex" must be locked. Returns "false" if subtitles for "pts" haven't been rendered yet.
+	// Doesn't need "assMutex": the revision is changed only with "subsMutex" locked or by the caller.
+	bool take(double pts, QMPlay2OSD *&osd)
+	{
+		const quint32 revision = videoThr.playC.ass->revision();
+		bool found = false;
+
+		QMutexLocker locker(&mutex);
+
+		if (lastPts >= 0.0 && pts > lastPts && pts - lastPts < 1.0)
+			step = pts - lastPts;
+		lastPts = pts;
+
+		QVector<Rendered> upcoming;
+		for (const Rendered &r : qAsConst(rendered))
+		{
+			if (r.revision == revision)
+			{
+				if (!found && qAbs(r.pts - pts) < g_subsPtsTolerance)
+				{
+					osd = r.osd;
+					found = true;
+					continue;
+				}
+				if (r.pts > pts && r.pts < pts + step * (g_subsRenderAhead + 1))
+				{
+					upcoming += r;
+					continue;
+				}
+			}
+			delete r.osd;
+		}
+		rendered = upcoming;
+
+		cond.wakeOne();
+		return found;
+	}
+
+	// "assMutex" must be locked. Every rendering must be done here, because libass detects changes since previous call.
+	QMPlay2OSD *render(double pts)
+	{
+		if (!videoThr.playC.ass->getASS(lastOSD, pts))
+		{
+			delete lastOSD;
+			lastOSD = nullptr;
+			return nullptr;
+		}
+		QMPlay2OSD *osd = new QMPlay2OSD;
+		osd->copyImages(*lastOSD);
+		osd->setPTS(pts);
+		return osd;
+	}
+
+private:
+	double nextPtsToRender() const
+	{
+		if (lastPts < 0.0 || step <= 0.0)
+			return -1.0;
+		for (int i = 1; i <= g_subsRenderAhead; ++i)
+		{
+			const double pts = lastPts + i * step;
+			bool hasPts = false;
+			for (const Rendered &r : rendered)
+			{
+				if (qAbs(r.pts - pts) < g_subsPtsTolerance)
+				{
+					hasPts = true;
+					break;
+				}
+			}
+			if (!hasPts)
+				return pts;
+		}
+		return -1.0;
+	}
+
+	void run() override
+	{
+		PlayClass &playC = videoThr.playC;
+		while (!br)
+		{
+			double pts = -1.0;
+
+			mutex.lock();
+			while (!br && (pts = nextPtsToRender()) < 0.0)
+				cond.wait(&mutex);
+			mutex.unlock();
+
+			// "VideoThr::lock()" holds this mutex, so "LibASS" can't be deleted while rendering
+			videoThr.subsRenderMutex.lock();
+			playC.assMutex.lock();
+			if (!br && playC.ass && !videoThr.sDec)
+			{
+				const quint32 revision = playC.ass->revision();
+				QMPlay2OSD *osd = render(pts);
+				mutex.lock();
+				rendered += Rendered{pts, revision, osd};
+				mutex.unlock();
+			}
+			else
+			{
+				mutex.lock();
+				lastPts = -1.0; //Wait for next request
+				mutex.unlock();
+			}
+			playC.assMutex.unlock();
+			videoThr.subsRenderMutex.unlock();
+		}
+	}
+
+	VideoThr &videoThr;
+
+	QMPlay2OSD *lastOSD; //Protected by "assMutex"
+
+	QVector<Rendered> rendered;
+	double lastPts, step;
+
+	QWaitCondition cond;
+	QMutex mutex;
+	volatile bool br;
+};
+
+/**/
+
 VideoThr::VideoThr(PlayClass &playC, VideoWriter *hwAccelWriter, const QStringList &pluginsName) :
 	AVThread(playC, "video:", hwAccelWriter, pluginsName),
 	doScreenshot(false),
@@ -47,8 +335,20 @@ VideoThr::VideoThr(PlayClass &playC, VideoWriter *hwAccelWriter, const QStringLi
 	W(0), H(0), seq(0),
 	sDec(nullptr),
 	hwAccelWriter(hwAccelWriter),
-	subtitles(nullptr)
+	subtitles(nullptr),
+	decodeAheadThr(nullptr),
+	hurryUp(0),
+	flushDecoded(false),
+	subsRenderThr(nullptr)
 {
+	//Unlocked together with "mutex" in "unlock()"
+	decodeMutex.lock();
+	subsRenderMutex.lock();
+	const int decodeAhead = QMPlay2Core.getSettings().getInt("VideoDecodeAhead");
+	if (writer && !hwAccelWriter && decodeAhead > 0) //Hardware decoders have limited number of surfaces
+		decodeAheadThr = new VideoDecodeAheadThr(*this, decodeAhead);
+	if (writer)
+		subsRenderThr = new SubtitlesRenderThr(*this);
 	maybeStartThread();
 }
 VideoThr::~VideoThr()
@@ -61,9 +361,67 @@ VideoThr::~VideoThr()
 	delete sDec;
 }
 
+bool VideoThr::lock()
+{
+	if (!AVThread::lock())
+		return false;
+	if (!tryLockBounded(decodeMutex))
+	{
+		AVThread::unlock();
+		return false;
+	}
+	if (!tryLockBounded(subsRenderMutex))
+	{
+		decodeMutex.unlock();
+		AVThread::unlock();
+		return false;
+	}
+	return true;
+}
+void VideoThr::unlock()
+{
+	if (decodeAheadThr && playC.flushVideo)
+	{
+		// Frames decoded before seeking are no longer valid
+		decodeAheadThr->clear();
+		flushDecoded = true;
+	}
+	subsRenderMutex.unlock();
+	decodeMutex.unlock();
+	AVThread::unlock();
+}
+
 void VideoThr::stop(bool terminate)
 {
 	playC.videoSeekPos = -1;
+	if (!terminate)
+	{
+		if (decodeAheadThr)
+			decodeAheadThr->requestStop();
+		if (subsRenderThr)
+			subsRenderThr->requestStop();
+		subsRenderMutex.unlock();
+		decodeMutex.unlock();
+		if (decodeAheadThr)
+			decodeAheadThr->wait();
+		if (subsRenderThr)
+			subsRenderThr->wait();
+	}
+	else
+	{
+		for (QThread *thr : {(QThread *)decodeAheadThr, (QThread *)subsRenderThr})
+		{
+			if (thr)
+			{
+				thr->terminate();
+				thr->wait(1000);
+			}
+		}
+	}
+	delete decodeAheadThr;
+	decodeAheadThr = nullptr;
+	delete subsRenderThr;
+	subsRenderThr = nullptr;
 	AVThread::stop(terminate);
 }
 
@@ -85,6 +443,11 @@ void VideoThr::destroySubtitlesDecoder()
 		delete sDec;
 		sDec = nullptr;
 	}
+	pendingSubsPackets.clear();
+}
+void VideoThr::discardPendingSubtitles()
+{
+	pendingSubsPackets.clear();
 }
 
 bool VideoThr::setSpherical()
@@ -205,7 +568,7 @@ void VideoThr::initFilters(bool processParams)
 			writer->processParams();
 	}
 
-	filters.start();
+	filters.start(QMPSettings.getInt("VideoFiltersQueueDepth"));
 }
 
 bool VideoThr::processParams()
@@ -219,7 +582,21 @@ void VideoThr::updateSubs()
 	{
 		playC.subsMutex.lock();
 		if (subtitles)
-			playC.ass->getASS(subtitles, playC.frame_last_pts + playC.frame_last_delay  - playC.subtitlesSync);
+		{
+			const double subsPts = playC.frame_last_pts + playC.frame_last_delay  - playC.subtitlesSync;
+			playC.assMutex.lock();
+			if (!subsRenderThr)
+			{
+				playC.ass->getASS(subtitles, subsPts);
+			}
+			else if (QMPlay2OSD *osd = subsRenderThr->render(subsPts))
+			{
+				subtitles->copyImages(*osd);
+				subtitles->setPTS(osd->pts());
+				delete osd;
+			}
+			playC.assMutex.unlock();
+		}
 		playC.subsMutex.unlock();
 	}
 }
@@ -229,6 +606,20 @@ inline VideoWriter *VideoThr::videoWriter() const
 	return (VideoWriter *)writer;
 }
 
+void VideoThr::decodePacket(Packet &packet, Decoded &decoded)
+{
+	const unsigned hurry_up = hurryUp;
+	decoded.bytesConsumed = dec->decodeVideo(packet, decoded.frame, decoded.newPixelFormat, playC.flushVideo, hurry_up);
+	decoded.skipped = (hurry_up == ~0u);
+	playC.flushVideo = false;
+
+	// This thread will wait for "DemuxerThr" which'll detect this error and restart with new decoder.
+	decoderError = (dec->hasCriticalError() || videoWriter()->hwAccelError());
+
+	packet.clear();
+	decoded.packet = packet;
+}
+
 void VideoThr::run()
 {
 	bool skip = false, paused = false, oneFrame = false, useLastDelay = false, lastOSDListEmpty = true, maybeFlush = false, lastAVDesync = false, interlaced = false, err = false;
@@ -281,12 +672,20 @@ void VideoThr::run()
 		}
 
 		const bool mustFetchNewPacket = !filters.readyRead();
-		playC.vPackets.lock();
-		const bool hasVPackets = playC.vPackets.canFetch();
-		if (maybeFlush || (!gotFrameOrError && !err && mustFetchNewPacket))
-			maybeFlush = playC.endOfStream && !hasVPackets;
+		bool hasVPackets = false, hasData = false;
+		if (decodeAheadThr)
+		{
+			hasData = decodeAheadThr->hasFrames();
+		}
+		else
+		{
+			hasVPackets = playC.vPackets.canFetch();
+			if (maybeFlush || (!gotFrameOrError && !err && mustFetchNewPacket))
+				maybeFlush = playC.endOfStream && !hasVPackets;
+			hasData = (maybeFlush || hasVPackets);
+		}
 		err = false;
-		if ((playC.paused && !oneFrame) || (!(maybeFlush || hasVPackets) && mustFetchNewPacket) || playC.waitForData || (playC.videoSeekPos <= 0.0 && playC.audioSeekPos > 0.0) || decoderError)
+		if ((playC.paused && !oneFrame) || (!hasData && mustFetchNewPacket) || playC.waitForData || (playC.videoSeekPos <= 0.0 && playC.audioSeekPos > 0.0) || decoderError)
 		{
 			if (playC.paused && !paused)
 			{
@@ -295,7 +694,6 @@ void VideoThr::run()
 				frame_timer = -1.0;
 				emit playC.updateBitrateAndFPS(-1, -1, -1.0, 0.0, interlaced); //Set real FPS to 0 on pause
 			}
-			playC.vPackets.unlock();
 
 			if (!playC.paused)
 				waiting = playC.fillBufferB = true;
@@ -311,19 +709,20 @@ void VideoThr::run()
 		paused = waiting = false;
 		Packet packet;
 		if (hasVPackets && mustFetchNewPacket)
-			packet = playC.vPackets.fetch();
+		{
+			if (!playC.vPackets.fetch(packet))
+				continue; //Buffer has been cleared or seeked in the meantime
+		}
 		else
+		{
 			packet.ts.setInvalid();
-		playC.vPackets.unlock();
+		}
 		processOneFrame();
 		playC.fillBufferB = true;
 
 		/* Subtitles packet */
 		Packet sPacket;
-		playC.sPackets.lock();
-		if (playC.sPackets.canFetch())
-			sPacket = playC.sPackets.fetch();
-		playC.sPackets.unlock();
+		playC.sPackets.fetch(sPacket);
 
 		mutex.lock();
 		if (br)
@@ -347,17 +746,48 @@ void VideoThr::run()
 		else
 		{
 			if (!sPacket.isEmpty())
+				pendingSubsPackets += sPacket;
+
+			QMPlay2OSD *osd = nullptr;
+			bool hasOSD;
+			if (playC.assMutex.tryLock()) //Never wait for "SubtitlesRenderThr"
 			{
-				const QByteArray sPacketData = QByteArray::fromRawData((const char *)sPacket.data(), sPacket.size());
-				if (playC.ass->isASS())
-					playC.ass->addASSEvent(sPacketData);
-				else
-					playC.ass->addASSEvent(Functions::convertToASS(sPacketData), sPacket.ts, sPacket.duration);
+				for (const Packet &packet : qAsConst(pendingSubsPackets))
+				{
+					const QByteArray packetData = QByteArray::fromRawData((const char *)packet.data(), packet.size());
+					if (playC.ass->isASS())
+						playC.ass->addASSEvent(packetData);
+					else
+						playC.ass->addASSEvent(Functions::convertToASS(packetData), packet.ts, packet.duration);
+				}
+				pendingSubsPackets.clear();
+				if (!subsRenderThr->take(subsPts, osd))
+					osd = subsRenderThr->render(subsPts);
+				hasOSD = true;
+				playC.assMutex.unlock();
 			}
-			if (!playC.ass->getASS(subtitles, subsPts))
+			else
 			{
-				osdListToDelete += subtitles;
-				subtitles = nullptr;
+				hasOSD = subsRenderThr->take(subsPts, osd);
+			}
+			if (hasOSD) //Otherwise subtitles are being rendered, keep the current ones for this frame
+			{
+				if (!osd)
+				{
+					osdListToDelete += subtitles;
+					subtitles = nullptr;
+				}
+				else if (subtitles && subtitles->getId() == osd->getId())
+				{
+					//Subtitles haven't changed
+					subtitles->setPTS(osd->pts());
+					delete osd;
+				}
+				else
+				{
+					osdListToDelete += subtitles;
+					subtitles = osd;
+				}
 			}
 		}
 		if (subtitles)
@@ -397,61 +827,66 @@ void VideoThr::run()
 		deleteSubs = deleteOSD = false;
 		/**/
 
+		hurryUp = skip ? ~0u : (fast >> 1);
+
 		filtersMutex.lock();
-		if (playC.flushVideo)
+		if (decodeAheadThr ? flushDecoded : playC.flushVideo)
 		{
 			filters.clearBuffers();
 			frame_timer = -1.0;
+			useLastDelay = true; //if seeking
+			flushDecoded = false;
 		}
 
-		if (!packet.isEmpty() || maybeFlush)
+		Decoded decoded;
+		bool hasDecoded = false;
+		if (decodeAheadThr)
 		{
-			VideoFrame decoded;
-			QByteArray newPixelFormat;
-			const int bytes_consumed = dec->decodeVideo(packet, decoded, newPixelFormat, playC.flushVideo, skip ? ~0 : (fast >> 1));
-			if (!newPixelFormat.isEmpty())
-				emit playC.pixelFormatUpdate(newPixelFormat);
-			if (playC.flushVideo)
-			{
-				useLastDelay = true; //if seeking
-				playC.flushVideo = false;
-			}
-			if (playC.videoSeekPos > 0.0 && bytes_consumed <= 0 && !packet.ts.isValid() && decoded.isEmpty())
+			hasDecoded = (mustFetchNewPacket && decodeAheadThr->take(decoded));
+		}
+		else if (!packet.isEmpty() || maybeFlush)
+		{
+			decodePacket(packet, decoded);
+			hasDecoded = true;
+		}
+		if (hasDecoded)
+		{
+			packet = decoded.packet;
+			if (!decoded.newPixelFormat.isEmpty())
+				emit playC.pixelFormatUpdate(decoded.newPixelFormat);
+			if (playC.videoSeekPos > 0.0 && decoded.bytesConsumed <= 0 && !packet.ts.isValid() && decoded.frame.isEmpty())
 				finishAccurateSeek();
-			if (!decoded.isEmpty())
+			if (!decoded.frame.isEmpty())
 			{
-				if (decoded.size.width != W || decoded.size.height != H)
+				if (decoded.frame.size.width != W || decoded.frame.size.height != H)
 				{
 					//Frame size has been changed
 					filtersMutex.unlock();
 					updateMutex.lock();
 					mutex.unlock();
-					emit playC.frameSizeUpdate(decoded.size.width, decoded.size.height);
+					emit playC.frameSizeUpdate(decoded.frame.size.width, decoded.frame.size.height);
 					updateMutex.lock(); //Wait for "frameSizeUpdate()" to be finished
 					mutex.lock();
 					updateMutex.unlock();
 					filtersMutex.lock();
 				}
-				interlaced = decoded.interlaced;
-				filters.addFrame(decoded, packet.ts);
+				interlaced = decoded.frame.interlaced;
+				filters.addFrame(decoded.frame, packet.ts);
 				gotFrameOrError = true;
 			}
-			else if (skip)
+			else if (decoded.skipped)
 				filters.removeLastFromInputBuffer();
-			if (bytes_consumed < 0)
+			if (decoded.bytesConsumed < 0)
 			{
 				gotFrameOrError = true;
 				err = true;
 			}
 			else
 			{
-				tmp_br += bytes_consumed;
+				tmp_br += decoded.bytesConsumed;
 			}
 		}
 
-		// This thread will wait for "DemuxerThr" which'll detect this error and restart with new decoder.
-		decoderError = (dec->hasCriticalError() || videoWriter()->hwAccelError());
-
 		const bool ptsIsValid = filters.getFrame(videoFrame, packet.ts);
 		filtersMutex.unlock();
 
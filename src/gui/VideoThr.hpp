@@ -21,17 +21,27 @@
 #include <AVThread.hpp>
 #include <VideoFilters.hpp>
 #include <PixelFormats.hpp>
+#include <Packet.hpp>
 
+#include <atomic>
+
+class VideoDecodeAheadThr;
+class SubtitlesRenderThr;
 class QMPlay2OSD;
 class VideoWriter;
 
 class VideoThr final : public AVThread
 {
 	Q_OBJECT
+	friend class VideoDecodeAheadThr;
+	friend class SubtitlesRenderThr;
 public:
 	VideoThr(PlayClass &, VideoWriter *, const QStringList &pluginsName = {});
 	~VideoThr();
 
+	bool lock() override;
+	void unlock() override;
+
 	void stop(bool terminate = false) override;
 
 	bool hasDecoderError() const override;
@@ -57,6 +67,7 @@ public:
 	}
 
 	void destroySubtitlesDecoder();
+	void discardPendingSubtitles(); //"subsMutex" must be locked
 	inline void setSubtitlesDecoder(Decoder *dec)
 	{
 		sDec = dec;
@@ -78,11 +89,23 @@ public:
 	void updateSubs();
 
 private:
+	struct Decoded
+	{
+		VideoFrame frame;
+		Packet packet; //Time stamp and aspect ratio of the decoded frame, packet data is released
+		QByteArray newPixelFormat;
+		int bytesConsumed = 0;
+		bool skipped = false;
+	};
+
 	inline VideoWriter *videoWriter() const;
 
+	void decodePacket(Packet &packet, Decoded &decoded);
+
 	void run() override;
 
-	bool deleteSubs, syncVtoA, doScreenshot, canWrite, deleteOSD, deleteFrame, gotFrameOrError, decoderError;
+	bool deleteSubs, syncVtoA, doScreenshot, canWrite, deleteOSD, deleteFrame;
+	std::atomic_bool gotFrameOrError, decoderError; //Also read by "VideoDecodeAheadThr"
 	double lastSampleAspectRatio;
 	int W, H;
 	quint32 seq;
@@ -92,6 +115,15 @@ private:
 	QMPlay2OSD *subtitles;
 	VideoFilters filters;
 	QMutex filtersMutex;
+
+	VideoDecodeAheadThr *decodeAheadThr;
+	QMutex decodeMutex;
+	std::atomic<unsigned> hurryUp;
+	bool flushDecoded;
+
+	SubtitlesRenderThr *subsRenderThr;
+	QMutex subsRenderMutex;
+	QVector<Packet> pendingSubsPackets; //Waiting for "assMutex", protected by "subsMutex"
 private slots:
 	void write(VideoFrame videoFrame, quint32 lastSeq);
 	void screenshot(VideoFrame videoFrame);
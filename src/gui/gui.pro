@@ -25,8 +25,8 @@ UI_DIR = build/ui
 INCLUDEPATH += . ../qmplay2/headers
 DEPENDPATH  += . ../qmplay2/headers
 
-HEADERS += Main.hpp MenuBar.hpp MainWidget.hpp AddressBox.hpp VideoDock.hpp InfoDock.hpp PlaylistDock.hpp PlayClass.hpp DemuxerThr.hpp AVThread.hpp VideoThr.hpp AudioThr.hpp SettingsWidget.hpp OSDSettingsW.hpp DeintSettingsW.hpp OtherVFiltersW.hpp PlaylistWidget.hpp EntryProperties.hpp AboutWidget.hpp AddressDialog.hpp VideoAdjustmentW.hpp Appearance.hpp VolWidget.hpp Updater.hpp ShortcutHandler.hpp KeyBindingsDialog.hpp PanGestureEventFilter.hpp EventFilterWorkarounds.hpp ScreenSaver.hpp RepeatMode.hpp
-SOURCES += Main.cpp MenuBar.cpp MainWidget.cpp AddressBox.cpp VideoDock.cpp InfoDock.cpp PlaylistDock.cpp PlayClass.cpp DemuxerThr.cpp AVThread.cpp VideoThr.cpp AudioThr.cpp SettingsWidget.cpp OSDSettingsW.cpp DeintSettingsW.cpp OtherVFiltersW.cpp PlaylistWidget.cpp EntryProperties.cpp AboutWidget.cpp AddressDialog.cpp VideoAdjustmentW.cpp Appearance.cpp VolWidget.cpp Updater.cpp ShortcutHandler.cpp KeyBindingsDialog.cpp PanGestureEventFilter.cpp EventFilterWorkarounds.cpp
+HEADERS += Main.hpp MenuBar.hpp MainWidget.hpp AddressBox.hpp VideoDock.hpp InfoDock.hpp PlaylistDock.hpp PlayClass.hpp DemuxerThr.hpp AVThread.hpp VideoThr.hpp AudioThr.hpp SettingsWidget.hpp OSDSettingsW.hpp DeintSettingsW.hpp OtherVFiltersW.hpp PlaylistWidget.hpp MetadataCache.hpp EntryProperties.hpp AboutWidget.hpp AddressDialog.hpp VideoAdjustmentW.hpp Appearance.hpp VolWidget.hpp Updater.hpp ShortcutHandler.hpp KeyBindingsDialog.hpp PanGestureEventFilter.hpp EventFilterWorkarounds.hpp ScreenSaver.hpp RepeatMode.hpp
+SOURCES += Main.cpp MenuBar.cpp MainWidget.cpp AddressBox.cpp VideoDock.cpp InfoDock.cpp PlaylistDock.cpp PlayClass.cpp DemuxerThr.cpp AVThread.cpp VideoThr.cpp AudioThr.cpp SettingsWidget.cpp OSDSettingsW.cpp DeintSettingsW.cpp OtherVFiltersW.cpp PlaylistWidget.cpp MetadataCache.cpp EntryProperties.cpp AboutWidget.cpp AddressDialog.cpp VideoAdjustmentW.cpp Appearance.cpp VolWidget.cpp Updater.cpp ShortcutHandler.cpp KeyBindingsDialog.cpp PanGestureEventFilter.cpp EventFilterWorkarounds.cpp
 FORMS += Ui/SettingsGeneral.ui Ui/SettingsPlayback.ui Ui/SettingsPlaybackModulesList.ui Ui/OSDSettings.ui
 
 !android {
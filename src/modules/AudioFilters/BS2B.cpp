@@ -20,7 +20,7 @@
 #include <Buffer.hpp>
 
 BS2B::BS2B(Module &module) :
-	m_hasParameters(false), m_canFilter(false),
+	m_enabled(false), m_hasParameters(false), m_canFilter(false),
 	m_srate(0),
 	m_bs2b(nullptr)
 {
@@ -33,11 +33,11 @@ BS2B::~BS2B()
 
 bool BS2B::set()
 {
-	m_enabled = sets().getBool("BS2B");
-	m_fcut = sets().getInt("BS2B/Fcut");
-	m_feed = sets().getDouble("BS2B/Feed") * 10;
-	m_canFilter = m_enabled && m_hasParameters;
-	alloc();
+	Params params;
+	params.enabled = sets().getBool("BS2B");
+	params.fcut = sets().getInt("BS2B/Fcut");
+	params.feed = sets().getDouble("BS2B/Feed") * 10;
+	m_params.publish(params);
 	return true;
 }
 
@@ -57,6 +57,15 @@ void BS2B::clearBuffers()
 double BS2B::filter(Buffer &data, bool flush)
 {
 	Q_UNUSED(flush)
+	if (m_params.update())
+	{
+		const Params &params = m_params.get();
+		m_enabled = params.enabled;
+		m_fcut = params.fcut;
+		m_feed = params.feed;
+		m_canFilter = m_enabled && m_hasParameters;
+		alloc();
+	}
 	if (m_canFilter)
 		bs2b_cross_feed_f(m_bs2b, (float *)data.data(), data.size() / sizeof(float) / 2);
 	return 0.0;
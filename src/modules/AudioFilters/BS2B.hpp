@@ -24,6 +24,12 @@
 
 class BS2B final : public AudioFilter
 {
+	struct Params
+	{
+		bool enabled;
+		qint32 fcut, feed;
+	};
+
 public:
 	BS2B(Module &module);
 	~BS2B();
@@ -36,6 +42,8 @@ private:
 
 	void alloc();
 
+	AudioFilterParams<Params> m_params;
+
 	bool m_enabled, m_hasParameters, m_canFilter;
 	qint32 m_fcut, m_feed;
 	quint32 m_srate;
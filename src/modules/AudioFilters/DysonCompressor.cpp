@@ -83,33 +83,28 @@ DysonCompressor::~DysonCompressor()
 
 bool DysonCompressor::set()
 {
-	QMutexLocker locker(&mutex);
+	Params newParams;
 
-	const bool newEnabled = sets().getBool("Compressor");
+	newParams.enabled = sets().getBool("Compressor");
 
-	peakpercent = sets().getInt("Compressor/PeakPercent");
-	releasetime = sets().getDouble("Compressor/ReleaseTime");
+	newParams.peakpercent = sets().getInt("Compressor/PeakPercent");
+	newParams.releasetime = sets().getDouble("Compressor/ReleaseTime");
 
 	// Compression ratio for fast gain. This will determine how
 	// much the audio is made more dense. 0.5 is equiv to 2:1
 	// compression. 1.0 is equiv to inf:1 compression.
-	fastgaincompressionratio = sets().getDouble("Compressor/FastGainCompressionRatio");
+	newParams.fastgaincompressionratio = sets().getDouble("Compressor/FastGainCompressionRatio");
 
 	// Overall ompression ratio.
-	compressionratio = sets().getDouble("Compressor/OverallCompressionRatio");
+	newParams.compressionratio = sets().getDouble("Compressor/OverallCompressionRatio");
 
-	if (newEnabled != enabled)
-	{
-		enabled = newEnabled;
-		clearBuffers();
-	}
+	params.publish(newParams);
 
 	return true;
 }
 
 bool DysonCompressor::setAudioParameters(uchar chn, uint srate)
 {
-	QMutexLocker locker(&mutex);
 	channels = chn;
 	sampleRate = srate;
 	clearBuffers();
@@ -144,11 +139,25 @@ void DysonCompressor::clearBuffers()
 }
 double DysonCompressor::filter(Buffer &data, bool flush)
 {
+	if (params.update())
+	{
+		const Params &newParams = params.get();
+
+		peakpercent = newParams.peakpercent;
+		releasetime = newParams.releasetime;
+		fastgaincompressionratio = newParams.fastgaincompressionratio;
+		compressionratio = newParams.compressionratio;
+
+		if (newParams.enabled != enabled)
+		{
+			enabled = newParams.enabled;
+			clearBuffers();
+		}
+	}
+
 	if (!enabled)
 		return 0.0;
 
-	QMutexLocker locker(&mutex);
-
 	if (!flush)
 	{
 		const int size = data.size() / sizeof(float);
@@ -20,13 +20,19 @@
 
 #include <AudioFilter.hpp>
 
-#include <QMutex>
-
 #define NFILT  12
 #define NEFILT 17
 
 class DysonCompressor final : public AudioFilter
 {
+	struct Params
+	{
+		bool enabled;
+		int peakpercent;
+		double releasetime;
+		double fastgaincompressionratio, compressionratio;
+	};
+
 public:
 	DysonCompressor(Module &module);
 	~DysonCompressor();
@@ -41,7 +47,7 @@ private:
 
 	using FloatVector = QVector<float>;
 
-	QMutex mutex;
+	AudioFilterParams<Params> params;
 	bool enabled;
 
 	int channels, sampleRate;
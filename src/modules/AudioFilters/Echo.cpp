@@ -22,25 +22,20 @@
 #include <Buffer.hpp>
 
 Echo::Echo(Module &module) :
-	hasParameters(false), canFilter(false)
+	enabled(false), hasParameters(false), canFilter(false)
 {
 	SetModule(module);
 }
 
 bool Echo::set()
 {
-	enabled = sets().getBool("Echo");
-	echo_delay = sets().getUInt("Echo/Delay");
-	echo_volume = sets().getUInt("Echo/Volume");
-	echo_repeat = sets().getUInt("Echo/Feedback");
-	echo_surround = sets().getBool("Echo/Surround");
-	if (echo_delay > 1000)
-		echo_delay = 1000;
-	if (echo_volume > 100)
-		echo_volume = 100;
-	if (echo_repeat > 100)
-		echo_repeat = 100;
-	alloc(enabled && hasParameters);
+	Params newParams;
+	newParams.enabled = sets().getBool("Echo");
+	newParams.delay = qMin(sets().getUInt("Echo/Delay"), 1000u);
+	newParams.volume = qMin(sets().getUInt("Echo/Volume"), 100u);
+	newParams.repeat = qMin(sets().getUInt("Echo/Feedback"), 100u);
+	newParams.surround = sets().getBool("Echo/Surround");
+	params.publish(newParams);
 	return true;
 }
 
@@ -57,6 +52,16 @@ bool Echo::setAudioParameters(uchar chn, uint srate)
 }
 double Echo::filter(Buffer &data, bool)
 {
+	if (params.update())
+	{
+		const Params &newParams = params.get();
+		enabled = newParams.enabled;
+		echo_delay = newParams.delay;
+		echo_volume = newParams.volume;
+		echo_repeat = newParams.repeat;
+		echo_surround = newParams.surround;
+		alloc(enabled && hasParameters);
+	}
 	if (canFilter)
 	{
 		const int size = data.size() / sizeof(float);
@@ -22,6 +22,13 @@
 
 class Echo final : public AudioFilter
 {
+	struct Params
+	{
+		bool enabled;
+		uint delay, volume, repeat;
+		bool surround;
+	};
+
 public:
 	Echo(Module &);
 
@@ -32,6 +39,8 @@ private:
 
 	void alloc(bool);
 
+	AudioFilterParams<Params> params;
+
 	bool enabled, hasParameters, canFilter;
 
 	uint echo_delay, echo_volume, echo_repeat;
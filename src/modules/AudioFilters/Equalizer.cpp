@@ -17,7 +17,6 @@
 */
 
 #include <Equalizer.hpp>
-#include <Buffer.hpp>
 
 extern "C"
 {
@@ -39,6 +38,12 @@ static inline float cosI(const float y1, const float y2, float p)
 	return y1 * (1.0f - p) + y2 * p;
 }
 
+static inline int partitionBits(int nbits)
+{
+	//Short partitions keep the latency low, but too many of them cost more than the FFT
+	return qMax(qMin(nbits - 1, 8), nbits - 4);
+}
+
 QVector<float> Equalizer::interpolate(const QVector<float> &src, const int len)
 {
 	QVector<float> dest(len);
@@ -78,9 +83,9 @@ float Equalizer::getAmpl(int val)
 }
 
 Equalizer::Equalizer(Module &module) :
-	FFT_NBITS(0), FFT_SIZE(0), FFT_SIZE_2(0),
-	canFilter(false), hasParameters(false), enabled(false),
-	mutex(QMutex::Recursive), fftIn(nullptr), fftOut(nullptr)
+	FFT_NBITS(0), PART_NBITS(0), PART_SIZE(0), PART_COUNT(0),
+	hasParameters(false),
+	canFilter(false), filterParts(nullptr), inputFill(0)
 {
 	SetModule(module);
 }
@@ -91,157 +96,206 @@ Equalizer::~Equalizer()
 
 bool Equalizer::set()
 {
-	mutex.lock();
-	enabled = sets().getBool("Equalizer");
-	if (FFT_NBITS && sets().getInt("Equalizer/nbits") != FFT_NBITS)
-		alloc(false);
-	alloc(enabled && hasParameters);
-	mutex.unlock();
+	paramsMutex.lock();
+	publishParams();
+	paramsMutex.unlock();
 	return true;
 }
 
 bool Equalizer::setAudioParameters(uchar chn, uint srate)
 {
+	alloc(false); //Channel count might have been changed, new parameters will be applied in "filter()"
+	paramsMutex.lock();
 	hasParameters = chn && srate;
 	if (hasParameters)
 	{
 		this->chn = chn;
 		this->srate = srate;
-		clearBuffers();
 	}
-	alloc(enabled && hasParameters);
+	publishParams();
+	paramsMutex.unlock();
 	return true;
 }
 int Equalizer::bufferedSamples() const
 {
-	if (canFilter)
-	{
-		mutex.lock();
-		int bufferedSamples = input.at(0).size();
-		mutex.unlock();
-		return bufferedSamples;
-	}
-	return 0;
+	return canFilter ? inputFill : 0;
 }
 void Equalizer::clearBuffers()
 {
-	mutex.lock();
-	if (canFilter)
+	for (ChannelPair &pair : pairs)
 	{
-		input.clear();
-		input.resize(chn);
-		last_samples.clear();
-		last_samples.resize(chn);
+		memset(pair.input, 0, 2 * PART_SIZE * sizeof(FFTComplex));
+		memset(pair.spectra, 0, 2 * PART_SIZE * PART_COUNT * sizeof(FFTComplex));
+		pair.spectraPos = 0;
 	}
-	mutex.unlock();
+	inputFill = 0;
 }
 double Equalizer::filter(Buffer &data, bool flush)
 {
+	if (params.update())
+		applyParams();
 	if (canFilter)
 	{
-		mutex.lock();
+		const int bufferedSamples = inputFill;
+		const int frames = data.size() / sizeof(float) / chn;
+		int outFrames = (bufferedSamples + frames) / PART_SIZE * PART_SIZE;
+		if (flush && (bufferedSamples + frames) % PART_SIZE) //Pad the last partition with silence
+			outFrames += PART_SIZE;
+
+		if (output.offset() > 0) //Can't be resized
+			output.clear();
+		output.resize(outFrames * chn * sizeof(float));
+
+		const float *src = (const float *)data.constData();
+		float *dst = (outFrames > 0) ? (float *)output.data() : nullptr;
+		for (int p = 0; p < pairs.count(); ++p)
+			filterPair(pairs[p], p * 2, src, frames, dst, flush);
+		inputFill = flush ? 0 : (bufferedSamples + frames) % PART_SIZE;
+		qSwap(data, output); //The input buffer will be reused for the next output
+
+		return bufferedSamples / (double)srate;
+	}
+	return 0.0;
+}
+
+void Equalizer::filterPair(ChannelPair &pair, int c, const float *src, int frames, float *dst, bool flush)
+{
+	const bool hasSecond = (c + 1 < chn);
+	int fill = inputFill;
+	int pos = 0;
+	for (;;)
+	{
+		//Deinterleave two channels into the current partition
+		const int n = qMin(PART_SIZE - fill, frames - pos);
+		FFTComplex *input = pair.input + PART_SIZE + fill;
+		const float *samples = src + pos * chn + c;
+		for (int i = 0; i < n; ++i, samples += chn)
+			input[i] = (FFTComplex){samples[0], hasSecond ? samples[1] : 0.0f};
+		fill += n;
+		pos += n;
 
-		if (!flush)
+		if (fill < PART_SIZE)
 		{
-			float *samples = (float *)data.data();
-			const int size = data.size() / sizeof(float);
-			for (int c = 0; c < chn; ++c) //Buforowanie danych
-				for (int i = 0; i < size; i += chn)
-					input[c].append(samples[c+i]);
+			if (!flush || fill == 0)
+				break;
+			memset(input + n, 0, (PART_SIZE - fill) * sizeof(FFTComplex));
 		}
-		else for (int c = 0; c < chn; ++c) //Dokładanie ciszy
-			input[c].resize(FFT_SIZE);
 
-		data.clear();
-		const int chunks = input.at(0).size() / FFT_SIZE_2 - 1;
-		if (chunks > 0) //Jeżeli jest wystarczająca ilość danych
+		processPartition(pair);
+
+		const FFTComplex *out = pair.output + PART_SIZE;
+		for (int i = 0; i < PART_SIZE; ++i, dst += chn)
 		{
-			data.resize(chn * sizeof(float) * FFT_SIZE_2 * chunks);
-			float *samples = (float *)data.data();
-			for (int c = 0; c < chn; ++c)
-			{
-				int pos = c;
-				while (input.at(c).size() >= FFT_SIZE)
-				{
-					for (int i = 0; i < FFT_SIZE; ++i)
-						complex[i] = (FFTComplex){input.at(c).at(i), 0.0f};
-					if (!flush)
-						input[c].remove(0, FFT_SIZE_2);
-					else
-						input[c].clear();
-
-					fft_calc(fftIn, complex);
-					for (int i = 0; i < FFT_SIZE_2; ++i)
-					{
-						const float coeff = f.at(i) * preamp;
-						complex[           i].re *= coeff;
-						complex[           i].im *= coeff;
-						complex[FFT_SIZE-1-i].re *= coeff;
-						complex[FFT_SIZE-1-i].im *= coeff;
-					}
-					fft_calc(fftOut, complex);
-
-					if (last_samples.at(c).isEmpty())
-					{
-						for (int i = 0; i < FFT_SIZE_2; ++i, pos += chn)
-							samples[pos] = complex[i].re / FFT_SIZE;
-						last_samples[c].resize(FFT_SIZE_2);
-					}
-					else for (int i = 0; i < FFT_SIZE_2; ++i, pos += chn)
-						samples[pos] = (complex[i].re / FFT_SIZE) * wind_f.at(i) + last_samples.at(c).at(i);
-
-					for (int i = FFT_SIZE_2; i < FFT_SIZE; ++i)
-						last_samples[c][i-FFT_SIZE_2] = (complex[i].re / FFT_SIZE) * wind_f.at(i);
-				}
-			}
+			dst[c] = out[i].re;
+			if (hasSecond)
+				dst[c + 1] = out[i].im;
 		}
+		fill = 0;
+	}
+}
+void Equalizer::processPartition(ChannelPair &pair)
+{
+	const int size = 2 * PART_SIZE;
 
-		mutex.unlock();
-		return FFT_SIZE / (double)srate;
+	FFTComplex *spectrum = pair.spectra + pair.spectraPos * size;
+	memcpy(spectrum, pair.input, size * sizeof(FFTComplex));
+	memcpy(pair.input, pair.input + PART_SIZE, PART_SIZE * sizeof(FFTComplex));
+	fft_calc(pair.fftIn, spectrum);
+
+	//Multiply and accumulate the spectra of the input partitions with the filter partitions
+	FFTComplex *out = pair.output;
+	memset(out, 0, size * sizeof(FFTComplex));
+	for (int p = 0; p < PART_COUNT; ++p)
+	{
+		const int spectraIdx = pair.spectraPos - p;
+		const FFTComplex *x = pair.spectra + (spectraIdx < 0 ? spectraIdx + PART_COUNT : spectraIdx) * size;
+		const FFTComplex *h = filterParts + p * size;
+		for (int i = 0; i < size; ++i)
+		{
+			out[i].re += x[i].re * h[i].re - x[i].im * h[i].im;
+			out[i].im += x[i].re * h[i].im + x[i].im * h[i].re;
+		}
 	}
-	return 0.0;
+	if (++pair.spectraPos == PART_COUNT)
+		pair.spectraPos = 0;
+
+	fft_calc(pair.fftOut, out);
 }
 
+void Equalizer::publishParams()
+{
+	Params newParams;
+	newParams.enabled = sets().getBool("Equalizer") && hasParameters;
+	newParams.nbits = sets().getInt("Equalizer/nbits");
+	if (newParams.enabled)
+	{
+		float preamp = 1.0f;
+		const QVector<float> curve = interpolateFilterCurve(1 << (newParams.nbits - 1), preamp);
+		newParams.filterParts = createFilter(newParams.nbits, curve, preamp);
+		if (!newParams.filterParts)
+			newParams.enabled = false;
+	}
+	params.publish(newParams);
+}
+
+void Equalizer::applyParams()
+{
+	const Params &newParams = params.get();
+	if (!newParams.enabled)
+	{
+		alloc(false);
+		return;
+	}
+	if (newParams.nbits != FFT_NBITS)
+		alloc(false);
+	if (pairs.isEmpty())
+	{
+		FFT_NBITS = newParams.nbits;
+		alloc(true);
+	}
+	filterParts = newParams.filterParts.get();
+	canFilter = true;
+}
 void Equalizer::alloc(bool b)
 {
-	mutex.lock();
-	if (!b && (fftIn || fftOut))
+	if (!b && !pairs.isEmpty())
 	{
 		canFilter = false;
-		FFT_NBITS = FFT_SIZE = FFT_SIZE_2 = 0;
-		av_fft_end(fftIn);
-		av_fft_end(fftOut);
-		fftIn = nullptr;
-		fftOut = nullptr;
-		av_free(complex);
-		complex = nullptr;
-		input.clear();
-		last_samples.clear();
-		wind_f.clear();
-		f.clear();
+		for (ChannelPair &pair : pairs)
+		{
+			av_fft_end(pair.fftIn);
+			av_fft_end(pair.fftOut);
+			av_free(pair.input);
+			av_free(pair.spectra);
+			av_free(pair.output);
+		}
+		pairs.clear();
+		FFT_NBITS = PART_NBITS = PART_SIZE = PART_COUNT = 0;
+		filterParts = nullptr;
+		inputFill = 0;
+		output.clear();
 	}
 	else if (b)
 	{
-		if (!fftIn || !fftOut)
+		PART_NBITS = partitionBits(FFT_NBITS);
+		PART_SIZE  = 1 << PART_NBITS;
+		PART_COUNT = (1 << FFT_NBITS) / PART_SIZE;
+
+		const int size = 2 * PART_SIZE;
+		pairs.resize((chn + 1) / 2);
+		for (ChannelPair &pair : pairs)
 		{
-			FFT_NBITS  = sets().getInt("Equalizer/nbits");
-			FFT_SIZE   = 1 << FFT_NBITS;
-			FFT_SIZE_2 = FFT_SIZE / 2;
-			fftIn  = av_fft_init(FFT_NBITS, false);
-			fftOut = av_fft_init(FFT_NBITS, true);
-			complex = (FFTComplex *)av_malloc(FFT_SIZE * sizeof(FFTComplex));
-			input.resize(chn);
-			last_samples.resize(chn);
-			wind_f.resize(FFT_SIZE);
-			for (int i = 0; i < FFT_SIZE; ++i)
-				wind_f[i] = 0.5f - 0.5f * cos(2.0f * M_PI * i / (FFT_SIZE - 1));
+			pair.fftIn  = av_fft_init(PART_NBITS + 1, false);
+			pair.fftOut = av_fft_init(PART_NBITS + 1, true);
+			pair.input = (FFTComplex *)av_mallocz(size * sizeof(FFTComplex));
+			pair.spectra = (FFTComplex *)av_mallocz(size * PART_COUNT * sizeof(FFTComplex));
+			pair.output = (FFTComplex *)av_malloc(size * sizeof(FFTComplex));
+			pair.spectraPos = 0;
 		}
-		interpolateFilterCurve();
-		canFilter = true;
+		inputFill = 0;
 	}
-	mutex.unlock();
 }
-void Equalizer::interpolateFilterCurve()
+QVector<float> Equalizer::interpolateFilterCurve(int len, float &preamp)
 {
 	const int size = sets().getInt("Equalizer/count");
 
@@ -263,9 +317,7 @@ void Equalizer::interpolateFilterCurve()
 		preamp = getAmpl(100 - preampVal);
 	}
 
-	const int len = FFT_SIZE_2;
-	if (f.size() != len)
-		f.resize(len);
+	QVector<float> f(len);
 	if (srate && size >= 2)
 	{
 		QVector<float> freqs = Equalizer::freqs(sets());
@@ -290,4 +342,91 @@ void Equalizer::interpolateFilterCurve()
 				f[i] = src[x];
 		}
 	}
+	return f;
+}
+std::shared_ptr<FFTComplex> Equalizer::createFilter(int nbits, const QVector<float> &curve, float preamp)
+{
+	/*
+	 * Minimum phase impulse response from the filter curve (homomorphic method),
+	 * so the filter doesn't add any noticeable delay.
+	 */
+	const int filterSize = 1 << nbits;
+	const int curveSize = curve.size();
+	const int size = filterSize * 2;
+	const int size_2 = size / 2;
+
+	FFTContext *fftIn = av_fft_init(nbits + 1, false);
+	FFTContext *fftOut = av_fft_init(nbits + 1, true);
+	FFTComplex *cplx = (FFTComplex *)av_malloc(size * sizeof(FFTComplex));
+	if (!fftIn || !fftOut || !cplx)
+	{
+		av_fft_end(fftIn);
+		av_fft_end(fftOut);
+		av_free(cplx);
+		return nullptr;
+	}
+
+	for (int i = 0; i <= size_2; ++i)
+	{
+		//Filter curve starts at the first bin of "filterSize" long FFT, here it has twice as many bins
+		const float pos = qBound(0.0f, i / 2.0f - 1.0f, curveSize - 1.0f);
+		const int x = pos;
+		const float ampl = (x + 1 < curveSize) ? curve.at(x) + (curve.at(x + 1) - curve.at(x)) * (pos - x) : curve.at(x);
+		cplx[i] = (FFTComplex){logf(qMax(ampl, 1e-5f)), 0.0f};
+		if (i > 0 && i < size_2)
+			cplx[size - i] = cplx[i];
+	}
+	fft_calc(fftOut, cplx);
+
+	//Fold the real cepstrum into a causal one
+	cplx[0] = (FFTComplex){cplx[0].re / size, 0.0f};
+	for (int i = 1; i < size_2; ++i)
+		cplx[i] = (FFTComplex){cplx[i].re * 2.0f / size, 0.0f};
+	cplx[size_2] = (FFTComplex){cplx[size_2].re / size, 0.0f};
+	memset(cplx + size_2 + 1, 0, (size_2 - 1) * sizeof(FFTComplex));
+	fft_calc(fftIn, cplx);
+
+	for (int i = 0; i < size; ++i)
+	{
+		const float ampl = expf(cplx[i].re);
+		cplx[i] = (FFTComplex){ampl * cosf(cplx[i].im), ampl * sinf(cplx[i].im)};
+	}
+	fft_calc(fftOut, cplx);
+
+	av_fft_end(fftIn);
+	av_fft_end(fftOut);
+
+	//Cut the impulse response to "filterSize" with a smooth fade out and split it into partitions
+	const int partNbits = partitionBits(nbits);
+	const int partSize = 1 << partNbits;
+	const int partCount = filterSize / partSize;
+	const int fadeLen = filterSize / 4;
+	const float scale = preamp / size / (2 * partSize); //Inverse FFTs are not normalized
+
+	std::shared_ptr<FFTComplex> filterParts((FFTComplex *)av_mallocz(2 * partSize * partCount * sizeof(FFTComplex)), av_free);
+	fftIn = av_fft_init(partNbits + 1, false);
+	if (!filterParts || !fftIn)
+	{
+		av_fft_end(fftIn);
+		av_free(cplx);
+		return nullptr;
+	}
+	for (int p = 0; p < partCount; ++p)
+	{
+		FFTComplex *part = filterParts.get() + p * 2 * partSize;
+		for (int i = 0; i < partSize; ++i)
+		{
+			const int n = p * partSize + i;
+			float coeff = cplx[n].re * scale;
+			if (n >= filterSize - fadeLen)
+				coeff *= 0.5f + 0.5f * cosf(M_PI * (n - filterSize + fadeLen) / fadeLen);
+			part[i] = (FFTComplex){coeff, 0.0f};
+		}
+		fft_calc(fftIn, part); //The second half is already zeroed
+	}
+	av_fft_end(fftIn);
+
+	av_free(cplx);
+
+	return filterParts;
 }
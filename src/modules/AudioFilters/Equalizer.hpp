@@ -19,12 +19,22 @@
 #pragma once
 
 #include <AudioFilter.hpp>
+#include <Buffer.hpp>
+
+#include <memory>
 
 struct FFTContext;
 struct FFTComplex;
 
 class Equalizer final : public AudioFilter
 {
+	struct Params
+	{
+		bool enabled = false;
+		int nbits = 0;
+		std::shared_ptr<FFTComplex> filterParts; //Complex spectra of the filter impulse response partitions, "av_malloc()"-ed for SIMD FFT
+	};
+
 public:
 	static QVector<float> interpolate(const QVector<float> &, const int);
 	static QVector<float> freqs(Settings &);
@@ -42,21 +52,40 @@ private:
 
 	/**/
 
+	struct ChannelPair
+	{
+		FFTContext *fftIn, *fftOut;
+		FFTComplex *input; //Previous and current partition, two channels as real and imaginary parts
+		FFTComplex *spectra; //Ring buffer with spectra of the last PART_COUNT partitions
+		FFTComplex *output;
+		int spectraPos;
+	};
+
+	void publishParams();
+	QVector<float> interpolateFilterCurve(int len, float &preamp);
+	std::shared_ptr<FFTComplex> createFilter(int nbits, const QVector<float> &curve, float preamp);
+
+	void applyParams();
 	void alloc(bool);
-	void interpolateFilterCurve();
 
-	int FFT_NBITS, FFT_SIZE, FFT_SIZE_2;
+	void filterPair(ChannelPair &pair, int c, const float *src, int frames, float *dst, bool flush);
+	void processPartition(ChannelPair &pair);
 
+	int FFT_NBITS, PART_NBITS, PART_SIZE, PART_COUNT;
+
+	//Changed only when "filter()" is not running
 	uchar chn;
 	uint srate;
-	bool canFilter, hasParameters, enabled;
-
-	mutable QMutex mutex;
-	FFTContext *fftIn, *fftOut;
-	FFTComplex *complex;
-	QVector<QVector<float>> input, last_samples;
-	QVector<float> wind_f, f;
-	float preamp;
+	bool hasParameters;
+
+	QMutex paramsMutex; //Never locked by "filter()"
+	AudioFilterParams<Params> params;
+
+	bool canFilter;
+	QVector<ChannelPair> pairs;
+	const FFTComplex *filterParts;
+	int inputFill;
+	Buffer output;
 };
 
 #define EqualizerName "Audio Equalizer"
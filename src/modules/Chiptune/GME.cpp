@@ -19,6 +19,7 @@
 #include <GME.hpp>
 #include <Common.hpp>
 
+#include <SampleConvert.hpp>
 #include <Functions.hpp>
 #include <Reader.hpp>
 #include <Packet.hpp>
@@ -85,8 +86,7 @@ bool GME::read(Packet &decoded, int &idx)
 	if (gme_play(m_gme, chunkSize, srcData) != nullptr)
 		return false;
 
-	for (int i = chunkSize - 1; i >= 0; --i)
-		dstData[i] = srcData[i] / 32768.0;
+	SampleConvert::s16ToFloat(dstData, srcData, chunkSize);
 
 	const double fadePos = t - (m_length - 5);
 	if (fadePos >= 0)
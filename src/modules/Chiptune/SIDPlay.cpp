@@ -19,6 +19,7 @@
 #include <SIDPlay.hpp>
 #include <Common.hpp>
 
+#include <SampleConvert.hpp>
 #include <Functions.hpp>
 #include <Reader.hpp>
 #include <Packet.hpp>
@@ -28,6 +29,8 @@
 #include <sidplayfp/SidTune.h>
 #include <sidplayfp/SidInfo.h>
 
+static constexpr int g_seekFastForward = 32; //Maximum allowed by "sidplayfp::fastForward()"
+
 SIDPlay::SIDPlay(Module &module) :
 	m_srate(Functions::getBestSampleRate()),
 	m_aborted(false),
@@ -76,14 +79,20 @@ bool SIDPlay::seek(double s, bool backward)
 	if (backward && !m_sidplay.load(m_tune)) //backward
 		return false;
 
-	if (s > 0.0)
+	const uint_least32_t pos = qMax(0.0, s);
+	if (m_sidplay.time() < pos)
 	{
-		const int pos = s;
-		const int bufferSize = m_chn * m_srate;
-		qint16 *buff1sec = new qint16[bufferSize];
-		for (int i = m_sidplay.time(); i <= pos && !m_aborted; ++i)
-			m_sidplay.play(buff1sec, bufferSize);
-		delete[] buff1sec;
+		//Emulate to the target position with the maximum fast forward, mixer output is skipped mostly
+		const int fastForward = m_sidplay.fastForward(g_seekFastForward * 100) ? g_seekFastForward : 1;
+		const int chunkSize = qMax<int>(1, m_srate / fastForward / 4) * m_chn; //~250 ms of the tune
+		if (m_seekBuffer.size() < chunkSize)
+			m_seekBuffer.resize(chunkSize);
+		while (m_sidplay.time() < pos && !m_aborted)
+		{
+			if (m_sidplay.play(m_seekBuffer.data(), chunkSize) == 0 && !m_sidplay.isPlaying())
+				break;
+		}
+		m_sidplay.fastForward(100);
 	}
 
 	return true;
@@ -108,8 +117,7 @@ bool SIDPlay::read(Packet &decoded, int &idx)
 
 	m_sidplay.play(srcData, chunkSize);
 
-	for (int i = chunkSize - 1; i >= 0; --i)
-		dstData[i] = srcData[i] / 16384.0;
+	SampleConvert::s16ToFloat(dstData, srcData, chunkSize, 1.0f / 16384.0f);
 
 	const double fadePos = m_time - (m_length - 5);
 	if (fadePos >= 0)
@@ -23,6 +23,8 @@
 #include <sidplayfp/builders/residfp.h>
 #include <sidplayfp/sidplayfp.h>
 
+#include <QVector>
+
 class SidTuneInfo;
 class Reader;
 
@@ -62,6 +64,8 @@ private:
 	int m_length;
 	quint8 m_chn;
 
+	QVector<qint16> m_seekBuffer;
+
 	QList<QMPlay2Tag> m_tags;
 	QString m_url, m_title;
 
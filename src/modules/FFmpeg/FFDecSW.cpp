@@ -19,6 +19,7 @@
 #include <FFDecSW.hpp>
 #include <FFCommon.hpp>
 
+#include <SampleConvert.hpp>
 #include <QMPlay2OSD.hpp>
 #include <VideoFrame.hpp>
 #include <StreamInfo.hpp>
@@ -126,69 +127,37 @@ int FFDecSW::decodeAudio(Packet &encodedPacket, Buffer &decoded, quint8 &channel
 			switch (codec_ctx->sample_fmt)
 			{
 				case AV_SAMPLE_FMT_U8:
-				{
-					uint8_t *data = (uint8_t *)*frame->data;
-					for (int i = 0; i < samples_with_channels; i++)
-						decoded_data[i] = (data[i] - 0x7F) / 128.0f;
-				} break;
+					SampleConvert::u8ToFloat(decoded_data, (const quint8 *)*frame->data, samples_with_channels);
+					break;
 				case AV_SAMPLE_FMT_S16:
-				{
-					int16_t *data = (int16_t *)*frame->data;
-					for (int i = 0; i < samples_with_channels; i++)
-						decoded_data[i] = data[i] / 32768.0f;
-				} break;
+					SampleConvert::s16ToFloat(decoded_data, (const qint16 *)*frame->data, samples_with_channels);
+					break;
 				case AV_SAMPLE_FMT_S32:
-				{
-					int32_t *data = (int32_t *)*frame->data;
-					for (int i = 0; i < samples_with_channels; i++)
-						decoded_data[i] = data[i] / 2147483648.0f;
-				} break;
+					SampleConvert::s32ToFloat(decoded_data, (const qint32 *)*frame->data, samples_with_channels);
+					break;
 				case AV_SAMPLE_FMT_FLT:
 					memcpy(decoded_data, *frame->data, decoded_size);
 					break;
 				case AV_SAMPLE_FMT_DBL:
-				{
-					double *data = (double *)*frame->data;
-					for (int i = 0; i < samples_with_channels; i++)
-						decoded_data[i] = data[i];
-				} break;
+					SampleConvert::dblToFloat(decoded_data, (const double *)*frame->data, samples_with_channels);
+					break;
 
 				/* Thanks Wang Bin for this patch */
 				case AV_SAMPLE_FMT_U8P:
-				{
-					uint8_t **data = (uint8_t **)frame->extended_data;
-					for (int i = 0; i < frame->nb_samples; ++i)
-						for (int ch = 0; ch < codec_ctx->channels; ++ch)
-							*decoded_data++ = (data[ch][i] - 0x7F) / 128.0f;
-				} break;
+					SampleConvert::planarToFloat(SampleConvert::U8, decoded_data, (const void *const *)frame->extended_data, codec_ctx->channels, frame->nb_samples);
+					break;
 				case AV_SAMPLE_FMT_S16P:
-				{
-					int16_t **data = (int16_t **)frame->extended_data;
-					for (int i = 0; i < frame->nb_samples; ++i)
-						for (int ch = 0; ch < codec_ctx->channels; ++ch)
-							*decoded_data++ = data[ch][i] / 32768.0f;
-				} break;
+					SampleConvert::planarToFloat(SampleConvert::S16, decoded_data, (const void *const *)frame->extended_data, codec_ctx->channels, frame->nb_samples);
+					break;
 				case AV_SAMPLE_FMT_S32P:
-				{
-					int32_t **data = (int32_t **)frame->extended_data;
-					for (int i = 0; i < frame->nb_samples; ++i)
-						for (int ch = 0; ch < codec_ctx->channels; ++ch)
-							*decoded_data++ = data[ch][i] / 2147483648.0f;
-				} break;
+					SampleConvert::planarToFloat(SampleConvert::S32, decoded_data, (const void *const *)frame->extended_data, codec_ctx->channels, frame->nb_samples);
+					break;
 				case AV_SAMPLE_FMT_FLTP:
-				{
-					float **data = (float **)frame->extended_data;
-					for (int i = 0; i < frame->nb_samples; ++i)
-						for (int ch = 0; ch < codec_ctx->channels; ++ch)
-							*decoded_data++ = data[ch][i];
-				} break;
+					SampleConvert::planarToFloat(SampleConvert::FLT, decoded_data, (const void *const *)frame->extended_data, codec_ctx->channels, frame->nb_samples);
+					break;
 				case AV_SAMPLE_FMT_DBLP:
-				{
-					double **data = (double **)frame->extended_data;
-					for (int i = 0; i < frame->nb_samples; ++i)
-						for (int ch = 0; ch < codec_ctx->channels; ++ch)
-							*decoded_data++ = data[ch][i];
-				} break;
+					SampleConvert::planarToFloat(SampleConvert::DBL, decoded_data, (const void *const *)frame->extended_data, codec_ctx->channels, frame->nb_samples);
+					break;
 				/**/
 
 				default:
@@ -251,8 +220,18 @@ int FFDecSW::decodeVideo(Packet &encodedPacket, VideoFrame &decoded, QByteArray
 			if (desiredPixFmt != AV_PIX_FMT_NONE)
 			{
 				const VideoFrameSize frameSize(frame->width, frame->height, chromaShiftW, chromaShiftH);
-				if (dontConvert && frame->buf[0] && frame->buf[1] && frame->buf[2])
-					decoded = VideoFrame(frameSize, frame->buf, frame->linesize, frame->interlaced_frame, frame->top_field_first);
+				if (dontConvert && canUseFrameBuffers(frameSize))
+				{
+					AVBufferRef *bufferRef[3];
+					qint32 offset[3];
+					for (int p = 0; p < 3; ++p)
+					{
+						AVBufferRef *planeBufferRef = av_frame_get_plane_buffer(frame, p);
+						bufferRef[p] = av_buffer_ref(planeBufferRef);
+						offset[p] = frame->data[p] - planeBufferRef->data;
+					}
+					decoded = VideoFrame(frameSize, bufferRef, frame->linesize, frame->interlaced_frame, frame->top_field_first, offset);
+				}
 				else
 				{
 					const int aligned8W = Functions::aligned(frame->width, 8);
@@ -365,6 +344,21 @@ bool FFDecSW::open(StreamInfo &streamInfo, VideoWriter *)
 }
 
 
+bool FFDecSW::canUseFrameBuffers(const VideoFrameSize &frameSize) const
+{
+	//Planes can share one buffer or start at any offset in it, but must be inside the buffer
+	for (int p = 0; p < 3; ++p)
+	{
+		const AVBufferRef *planeBufferRef = av_frame_get_plane_buffer(frame, p);
+		if (!planeBufferRef || frame->linesize[p] <= 0)
+			return false;
+		const quint8 *planeEnd = frame->data[p] + frame->linesize[p] * frameSize.getHeight(p);
+		if (frame->data[p] < planeBufferRef->data || planeEnd > planeBufferRef->data + planeBufferRef->size)
+			return false;
+	}
+	return true;
+}
+
 void FFDecSW::setPixelFormat()
 {
 	const AVPixFmtDescriptor *pixDesc = av_pix_fmt_desc_get(codec_ctx->pix_fmt);
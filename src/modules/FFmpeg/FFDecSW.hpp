@@ -23,6 +23,7 @@
 #include <QString>
 #include <QList>
 
+class VideoFrameSize;
 struct SwsContext;
 
 class FFDecSW final : public FFDec
@@ -62,6 +63,7 @@ private:
 
 	/**/
 
+	bool canUseFrameBuffers(const VideoFrameSize &frameSize) const;
 	void setPixelFormat();
 
 	inline void addBitmapSubBuffer(BitmapSubBuffer *buff, double pos);
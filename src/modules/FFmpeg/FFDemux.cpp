@@ -26,9 +26,12 @@
 
 #include <QFile>
 
-FFDemux::FFDemux(Module &module) :
+FFDemux::FFDemux(Module &module, ProbeCache &probeCache) :
 	abortFetchTracks(false),
-	reconnectStreamed(false)
+	reconnectStreamed(false),
+	useReadahead(false),
+	probeCache(probeCache),
+	useProbeCache(false)
 {
 	SetModule(module);
 }
@@ -50,6 +53,10 @@ bool FFDemux::set()
 		restartPlayback = true;
 	}
 
+	useReadahead = sets().getBool("ReadaheadIO");
+	probeBudgets.load(sets());
+	useProbeCache = sets().getBool("ProbeCache");
+
 	return sets().getBool("DemuxerEnabled") && !restartPlayback;
 }
 
@@ -454,7 +461,7 @@ Playlist::Entries FFDemux::fetchTracks(const QString &url, bool &ok)
 
 void FFDemux::addFormatContext(QString url, const QString &param)
 {
-	FormatContext *fmtCtx = new FormatContext(reconnectStreamed);
+	FormatContext *fmtCtx = new FormatContext(reconnectStreamed, useReadahead, probeBudgets, useProbeCache ? &probeCache : nullptr);
 	{
 		QMutexLocker mL(&mutex);
 		formatContexts.append(fmtCtx);
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <ProbeCache.hpp>
 #include <Demuxer.hpp>
 
 class FormatContext;
@@ -26,7 +27,7 @@ class FFDemux final : public Demuxer
 {
 	Q_DECLARE_TR_FUNCTIONS(FFDemux)
 public:
-	FFDemux(Module &);
+	FFDemux(Module &, ProbeCache &probeCache);
 private:
 	~FFDemux();
 
@@ -69,4 +70,9 @@ private:
 
 	bool abortFetchTracks;
 	bool reconnectStreamed;
+	bool useReadahead;
+
+	ProbeBudgets probeBudgets;
+	ProbeCache &probeCache;
+	bool useProbeCache;
 };
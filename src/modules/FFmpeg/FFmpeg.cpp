@@ -69,6 +69,13 @@ FFmpeg::FFmpeg() :
 
 	init("DemuxerEnabled", true);
 	init("ReconnectStreammes", false);
+	init("ProbeSizeLocal", 0);
+	init("AnalyzeDurationLocal", 0);
+	init("ProbeSizeNetwork", 0);
+	init("AnalyzeDurationNetwork", 0);
+	init("FormatProbeBudgets", QString());
+	init("ProbeCache", true);
+	init("ReadaheadIO", true);
 	init("DecoderEnabled", true);
 #ifdef QMPlay2_VDPAU
 	init("DecoderVDPAUEnabled", true);
@@ -185,7 +192,7 @@ QList<FFmpeg::Info> FFmpeg::getModulesInfo(const bool showDisabled) const
 void *FFmpeg::createInstance(const QString &name)
 {
 	if (name == DemuxerName && getBool("DemuxerEnabled"))
-		return new FFDemux(*this);
+		return new FFDemux(*this, probeCache);
 	else if (name == DecoderName && getBool("DecoderEnabled"))
 		return new FFDecSW(*this);
 #ifdef QMPlay2_VDPAU
@@ -241,6 +248,7 @@ QMPLAY2_EXPORT_MODULE(FFmpeg)
 #include <QGridLayout>
 #include <QFormLayout>
 #include <QGroupBox>
+#include <QLineEdit>
 #include <QCheckBox>
 #include <QSpinBox>
 #include <QLabel>
@@ -259,6 +267,29 @@ ModuleSettingsWidget::ModuleSettingsWidget(Module &module) :
 	reconnectStreamedB = new QCheckBox(tr("Try to automatically reconnect live streams on error"));
 	reconnectStreamedB->setChecked(sets().getBool("ReconnectStreamed"));
 
+	const auto createProbeSpinBox = [this](const QString &key, const QString &suffix) {
+		QSpinBox *spinBox = new QSpinBox;
+		spinBox->setRange(0, 1024 * 1024);
+		spinBox->setSuffix(suffix);
+		spinBox->setSpecialValueText(tr("Default"));
+		spinBox->setValue(sets().getInt(key));
+		return spinBox;
+	};
+	probeSizeLocalB = createProbeSpinBox("ProbeSizeLocal", " KiB");
+	analyzeDurationLocalB = createProbeSpinBox("AnalyzeDurationLocal", " ms");
+	probeSizeNetworkB = createProbeSpinBox("ProbeSizeNetwork", " KiB");
+	analyzeDurationNetworkB = createProbeSpinBox("AnalyzeDurationNetwork", " ms");
+
+	formatProbeBudgetsE = new QLineEdit(sets().getString("FormatProbeBudgets"));
+	formatProbeBudgetsE->setPlaceholderText("mpegts=1024:500; hls=512:250");
+	formatProbeBudgetsE->setToolTip(tr("Format specific limits of streams probing: \"format=size in KiB:duration in ms\" separated by semicolons"));
+
+	probeCacheB = new QCheckBox(tr("Remember streams parameters of local files to open them faster"));
+	probeCacheB->setChecked(sets().getBool("ProbeCache"));
+
+	readaheadB = new QCheckBox(tr("Read local files and seekable network streams ahead in background"));
+	readaheadB->setChecked(sets().getBool("ReadaheadIO"));
+
 	decoderB = new QGroupBox(tr("Software decoder"));
 	decoderB->setCheckable(true);
 	decoderB->setChecked(sets().getBool("DecoderEnabled"));
@@ -392,6 +423,13 @@ ModuleSettingsWidget::ModuleSettingsWidget(Module &module) :
 
 	QFormLayout *demuxerLayout = new QFormLayout(demuxerB);
 	demuxerLayout->addRow(nullptr, reconnectStreamedB);
+	demuxerLayout->addRow(tr("Probe size of local files") + ": ", probeSizeLocalB);
+	demuxerLayout->addRow(tr("Analyze duration of local files") + ": ", analyzeDurationLocalB);
+	demuxerLayout->addRow(tr("Probe size of network streams") + ": ", probeSizeNetworkB);
+	demuxerLayout->addRow(tr("Analyze duration of network streams") + ": ", analyzeDurationNetworkB);
+	demuxerLayout->addRow(tr("Format specific probe limits") + ": ", formatProbeBudgetsE);
+	demuxerLayout->addRow(nullptr, probeCacheB);
+	demuxerLayout->addRow(nullptr, readaheadB);
 
 	QFormLayout *decoderLayout = new QFormLayout(decoderB);
 	decoderLayout->addRow(tr("Number of threads used to decode video") + ": ", threadsB);
@@ -439,6 +477,13 @@ void ModuleSettingsWidget::saveSettings()
 {
 	sets().set("DemuxerEnabled", demuxerB->isChecked());
 	sets().set("ReconnectStreamed", reconnectStreamedB->isChecked());
+	sets().set("ProbeSizeLocal", probeSizeLocalB->value());
+	sets().set("AnalyzeDurationLocal", analyzeDurationLocalB->value());
+	sets().set("ProbeSizeNetwork", probeSizeNetworkB->value());
+	sets().set("AnalyzeDurationNetwork", analyzeDurationNetworkB->value());
+	sets().set("FormatProbeBudgets", formatProbeBudgetsE->text().trimmed());
+	sets().set("ProbeCache", probeCacheB->isChecked());
+	sets().set("ReadaheadIO", readaheadB->isChecked());
 	sets().set("DecoderEnabled", decoderB->isChecked());
 	sets().set("HurryUP", hurryUpB ->isChecked());
 	sets().set("SkipFrames", skipFramesB->isChecked());
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <ProbeCache.hpp>
 #include <Module.hpp>
 
 #include <QCoreApplication>
@@ -41,6 +42,7 @@ private:
 	/**/
 
 	QIcon demuxIcon;
+	ProbeCache probeCache;
 #ifdef QMPlay2_VDPAU
 	QIcon vdpauIcon;
 	QComboBox *vdpauDeintMethodB;
@@ -60,6 +62,7 @@ private:
 
 /**/
 
+class QLineEdit;
 class QCheckBox;
 class QGroupBox;
 class QSpinBox;
@@ -88,6 +91,11 @@ private:
 
 	QGroupBox *demuxerB;
 	QCheckBox *reconnectStreamedB;
+	QSpinBox *probeSizeLocalB, *analyzeDurationLocalB;
+	QSpinBox *probeSizeNetworkB, *analyzeDurationNetworkB;
+	QLineEdit *formatProbeBudgetsE;
+	QCheckBox *probeCacheB;
+	QCheckBox *readaheadB;
 	QGroupBox *hurryUpB;
 	QCheckBox *skipFramesB, *forceSkipFramesB;
 	QGroupBox *decoderB;
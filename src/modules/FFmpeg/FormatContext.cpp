@@ -18,6 +18,7 @@
 
 #include <FFCommon.hpp>
 #include <FormatContext.hpp>
+#include <ReadaheadIO.hpp>
 
 #include <QMPlay2Core.hpp>
 #include <Functions.hpp>
@@ -170,12 +171,14 @@ class OpenFmtCtxThr : public OpenThr
 {
 	AVFormatContext *m_formatCtx;
 	AVInputFormat *m_inputFmt;
+	std::shared_ptr<ReadaheadIO> m_readahead; //Must live until "avformat_open_input()" finishes
 
 public:
-	inline OpenFmtCtxThr(AVFormatContext *formatCtx, const QByteArray &url, AVInputFormat *inputFmt, AVDictionary *options, std::shared_ptr<AbortContext> &abortCtx) :
+	inline OpenFmtCtxThr(AVFormatContext *formatCtx, const QByteArray &url, AVInputFormat *inputFmt, AVDictionary *options, std::shared_ptr<AbortContext> &abortCtx, const std::shared_ptr<ReadaheadIO> &readahead) :
 		OpenThr(url, options, abortCtx),
 		m_formatCtx(formatCtx),
-		m_inputFmt(inputFmt)
+		m_inputFmt(inputFmt),
+		m_readahead(readahead)
 	{
 		start();
 	}
@@ -188,7 +191,19 @@ public:
 private:
 	void run() override
 	{
-		avformat_open_input(&m_formatCtx, m_url, m_inputFmt, &m_options);
+		if (m_readahead && !m_formatCtx->pb)
+		{
+			//Network stream, connect here, because it can take a while
+			if (m_readahead->openNetwork(m_url, &m_options))
+				m_formatCtx->pb = m_readahead->pb;
+			else
+			{
+				avformat_free_context(m_formatCtx);
+				m_formatCtx = nullptr;
+			}
+		}
+		if (m_formatCtx)
+			avformat_open_input(&m_formatCtx, m_url, m_inputFmt, &m_options);
 		if (!wakeIfNotAborted() && m_formatCtx)
 			avformat_close_input(&m_formatCtx);
 	}
@@ -196,7 +211,7 @@ private:
 
 /**/
 
-FormatContext::FormatContext(bool reconnectStreamed) :
+FormatContext::FormatContext(bool reconnectStreamed, bool useReadahead, const ProbeBudgets &probeBudgets, ProbeCache *probeCache) :
 	isError(false),
 	currPos(0.0),
 	abortCtx(new AbortContext),
@@ -204,6 +219,9 @@ FormatContext::FormatContext(bool reconnectStreamed) :
 	packet(nullptr),
 	oggHelper(nullptr),
 	reconnectStreamed(reconnectStreamed),
+	useReadahead(useReadahead),
+	probeBudgets(probeBudgets),
+	probeCache(probeCache),
 	isPaused(false), fixMkvAss(false),
 	isMetadataChanged(false),
 	lastTime(0.0),
@@ -719,11 +737,26 @@ bool FormatContext::open(const QString &_url, const QString &param)
 		formatCtx->pb = oggHelper->pb;
 		av_dict_set(&options, "skip_initial_bytes", QString::number(oggOffset).toLatin1(), 0);
 	}
+	else if (useReadahead && !inputFmt)
+	{
+		if (isLocal)
+		{
+			readahead = std::make_shared<ReadaheadIO>(abortCtx);
+			if (readahead->openFile(url))
+				formatCtx->pb = readahead->pb;
+			else
+				readahead.reset();
+		}
+		else if (scheme == "http" || scheme == "https")
+		{
+			readahead = std::make_shared<ReadaheadIO>(abortCtx); //Opened in "OpenFmtCtxThr"
+		}
+	}
 
 	// Useful, e.g. CUVID decoder needs valid PTS
 	formatCtx->flags |= AVFMT_FLAG_GENPTS;
 
-	OpenFmtCtxThr *openThr = new OpenFmtCtxThr(formatCtx, url.toUtf8(), inputFmt, options, abortCtx);
+	OpenFmtCtxThr *openThr = new OpenFmtCtxThr(formatCtx, url.toUtf8(), inputFmt, options, abortCtx, readahead);
 	formatCtx = openThr->getFormatCtx();
 	openThr->drop();
 	if (!formatCtx || disabledDemuxers.contains(name()))
@@ -739,7 +772,12 @@ bool FormatContext::open(const QString &_url, const QString &param)
 	if (name() == "mp3")
 		formatCtx->flags |= AVFMT_FLAG_FAST_SEEK; //This should be set before "avformat_open_input", but seems to be working for MP3...
 
-	if (avformat_find_stream_info(formatCtx, nullptr) < 0)
+	probeBudgets.apply(formatCtx, isLocal);
+
+	const bool streamInfoFound = (probeCache && isLocal && !oggHelper)
+		? probeCache->findStreamInfo(url, formatCtx)
+		: (avformat_find_stream_info(formatCtx, nullptr) >= 0);
+	if (!streamInfoFound)
 		return false;
 
 	isStreamed = !isLocal && formatCtx->duration <= 0; //QMPLAY2_NOPTS_VALUE is negative
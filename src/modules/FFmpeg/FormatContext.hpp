@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <ProbeCache.hpp>
 #include <OpenThr.hpp>
 
 #include <ChapterProgramInfo.hpp>
@@ -34,6 +35,7 @@ struct AVFormatContext;
 struct AVDictionary;
 struct AVStream;
 struct AVPacket;
+class ReadaheadIO;
 class OggHelper;
 struct Packet;
 
@@ -41,7 +43,7 @@ class FormatContext
 {
 	Q_DECLARE_TR_FUNCTIONS(FormatContext)
 public:
-	FormatContext(bool reconnectStreamed = false);
+	FormatContext(bool reconnectStreamed, bool useReadahead, const ProbeBudgets &probeBudgets, ProbeCache *probeCache);
 	~FormatContext();
 
 	bool metadataChanged() const;
@@ -87,8 +89,11 @@ private:
 	AVPacket *packet;
 
 	OggHelper *oggHelper;
+	std::shared_ptr<ReadaheadIO> readahead;
 
-	bool reconnectStreamed;
+	bool reconnectStreamed, useReadahead;
+	const ProbeBudgets probeBudgets;
+	ProbeCache *const probeCache;
 	bool isPaused, fixMkvAss;
 	mutable bool isMetadataChanged;
 	double lastTime, startTime;
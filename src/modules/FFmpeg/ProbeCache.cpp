@@ -0,0 +1,428 @@
+/*
+	QMPlay2 is a video and audio player.
+	Copyright (C) 2010-2018  Błażej Szczygieł
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU Lesser General Public License as published
+	by the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <ProbeCache.hpp>
+
+#include <QMPlay2Core.hpp>
+#include <Settings.hpp>
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QRegExp>
+#include <QFile>
+
+extern "C"
+{
+	#include <libavformat/avformat.h>
+}
+
+#include <cstring>
+
+static constexpr quint32 g_magic = 0x514D5043; //"QMPC"
+static constexpr quint32 g_version = 2;
+static constexpr int g_maxEntries = 10000; //Entries not used in current session are dropped above this
+static constexpr int g_hashedSize = 64 * 1024;
+
+static bool formatNameMatches(const char *formatNames, const QByteArray &name)
+{
+	//"formatNames" can contain many names separated by comma, e.g. "mov,mp4,m4a,3gp,3g2,mj2"
+	const QByteArray names = QByteArray::fromRawData(formatNames, strlen(formatNames));
+	for (const QByteArray &formatName : names.split(','))
+	{
+		if (formatName == name)
+			return true;
+	}
+	return false;
+}
+
+/**/
+
+void ProbeBudgets::load(Settings &sets)
+{
+	m_local.probeSize = sets.getInt("ProbeSizeLocal") * 1024LL;
+	m_local.analyzeDuration = sets.getInt("AnalyzeDurationLocal") * 1000LL;
+	m_network.probeSize = sets.getInt("ProbeSizeNetwork") * 1024LL;
+	m_network.analyzeDuration = sets.getInt("AnalyzeDurationNetwork") * 1000LL;
+
+	//"format=probeSizeKiB:analyzeDurationMs" separated by semicolons or spaces, empty or 0 value means scheme limit
+	m_formats.clear();
+	for (const QString &item : sets.getString("FormatProbeBudgets").split(QRegExp("[;\\s]+"), QString::SkipEmptyParts))
+	{
+		const int eqIdx = item.indexOf('=');
+		if (eqIdx <= 0)
+			continue;
+		const QStringList values = item.mid(eqIdx + 1).split(':');
+		Budget budget;
+		budget.probeSize = qMax(0LL, values.value(0).toLongLong() * 1024LL);
+		budget.analyzeDuration = qMax(0LL, values.value(1).toLongLong() * 1000LL);
+		m_formats[item.left(eqIdx).trimmed().toLatin1()] = budget;
+	}
+}
+
+ProbeBudgets::Budget ProbeBudgets::get(bool isLocal, const char *formatName) const
+{
+	Budget budget = isLocal ? m_local : m_network;
+	if (formatName)
+	{
+		for (auto it = m_formats.constBegin(), itEnd = m_formats.constEnd(); it != itEnd; ++it)
+		{
+			if (!formatNameMatches(formatName, it.key()))
+				continue;
+			if (it->probeSize > 0)
+				budget.probeSize = it->probeSize;
+			if (it->analyzeDuration > 0)
+				budget.analyzeDuration = it->analyzeDuration;
+			break;
+		}
+	}
+	return budget;
+}
+
+void ProbeBudgets::apply(AVFormatContext *formatCtx, bool isLocal) const
+{
+	const Budget budget = get(isLocal, formatCtx->iformat ? formatCtx->iformat->name : nullptr);
+	if (budget.probeSize > 0)
+		formatCtx->probesize = qMax<qint64>(32, budget.probeSize); //FFmpeg minimum
+	if (budget.analyzeDuration > 0)
+		formatCtx->max_analyze_duration = budget.analyzeDuration;
+}
+
+/**/
+
+ProbeCache::ProbeCache() :
+	m_cacheFilePath(QMPlay2Core.getSettingsDir() + "FFmpegProbeCache.bin")
+{}
+ProbeCache::~ProbeCache()
+{
+	save();
+}
+
+bool ProbeCache::findStreamInfo(const QString &filePath, AVFormatContext *formatCtx)
+{
+	FileId fileId;
+	const bool hasFileId = isCacheable(formatCtx) && getFileId(filePath, fileId);
+
+	if (hasFileId && restore(filePath, fileId, formatCtx))
+		return true;
+
+	if (avformat_find_stream_info(formatCtx, nullptr) < 0)
+		return false;
+
+	const AVIOInterruptCB &interruptCB = formatCtx->interrupt_callback;
+	const bool aborted = interruptCB.callback && interruptCB.callback(interruptCB.opaque);
+	if (hasFileId && !aborted) //Don't store incomplete parameters
+	{
+		insert(filePath, fileId, formatCtx);
+		save(); //Probing took much longer than writing the cache, nothing is lost on crash
+	}
+
+	return true;
+}
+
+void ProbeCache::save()
+{
+	QMutexLocker locker(&m_mutex);
+	if (!m_modified)
+		return;
+
+	if (m_entries.count() > g_maxEntries)
+	{
+		for (auto it = m_entries.begin(); it != m_entries.end();)
+		{
+			if (!it->used)
+				it = m_entries.erase(it);
+			else
+				++it;
+		}
+	}
+
+	QSaveFile file(m_cacheFilePath);
+	if (!file.open(QFile::WriteOnly))
+		return;
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_6);
+	stream << g_magic << g_version << (quint32)m_entries.count();
+	for (auto it = m_entries.constBegin(), itEnd = m_entries.constEnd(); it != itEnd; ++it)
+	{
+		stream << it.key() << it->fileId.size << it->fileId.mTime << it->fileId.hash;
+		stream << it->formatName << it->startTime << it->duration << it->bitRate << (quint32)it->streams.count();
+		for (const StreamParams &sp : it->streams)
+		{
+			stream << sp.codecType << sp.codecId << sp.codecTag << sp.format << sp.bitRate;
+			stream << sp.bitsPerCodedSample << sp.bitsPerRawSample << sp.profile << sp.level;
+			stream << sp.width << sp.height << sp.sarNum << sp.sarDen;
+			stream << sp.fieldOrder << sp.colorRange << sp.colorPrimaries << sp.colorTrc << sp.colorSpace << sp.chromaLocation;
+			stream << sp.videoDelay << sp.initialPadding << sp.trailingPadding << sp.seekPreroll;
+			stream << sp.channelLayout << sp.channels << sp.sampleRate << sp.blockAlign << sp.frameSize;
+			stream << sp.extradata << sp.timeBaseNum << sp.timeBaseDen;
+			stream << sp.rFrameRateNum << sp.rFrameRateDen << sp.avgFrameRateNum << sp.avgFrameRateDen;
+			stream << sp.streamSarNum << sp.streamSarDen << sp.startTime << sp.duration << sp.codecInfoNbFrames;
+		}
+	}
+
+	if (stream.status() == QDataStream::Ok && file.commit())
+		m_modified = false;
+}
+
+bool ProbeCache::isCacheable(const AVFormatContext *formatCtx)
+{
+	//Formats which have all streams described in header, other formats (e.g. MPEG-TS) can find streams while probing
+	static const QByteArray cacheableFormats[] = {
+		"matroska",
+		"mov",
+		"avi",
+		"asf",
+		"flac",
+		"wav",
+	};
+	if (!formatCtx->iformat || (formatCtx->ctx_flags & AVFMTCTX_NOHEADER))
+		return false;
+	for (const QByteArray &formatName : cacheableFormats)
+	{
+		if (formatNameMatches(formatCtx->iformat->name, formatName))
+			return true;
+	}
+	return false;
+}
+bool ProbeCache::getFileId(const QString &filePath, FileId &fileId)
+{
+	const QFileInfo fileInfo(filePath);
+	if (!fileInfo.isFile())
+		return false;
+
+	QFile file(filePath);
+	if (!file.open(QFile::ReadOnly))
+		return false;
+
+	fileId.size = fileInfo.size();
+	fileId.mTime = fileInfo.lastModified().toMSecsSinceEpoch();
+	fileId.hash = QCryptographicHash::hash(file.read(g_hashedSize), QCryptographicHash::Md5);
+	return true;
+}
+
+bool ProbeCache::restore(const QString &filePath, const FileId &fileId, AVFormatContext *formatCtx)
+{
+	QMutexLocker locker(&m_mutex);
+	load();
+
+	auto it = m_entries.find(filePath);
+	if (it == m_entries.end())
+		return false;
+
+	if (it->fileId.size != fileId.size || it->fileId.mTime != fileId.mTime || it->fileId.hash != fileId.hash)
+	{
+		m_entries.erase(it);
+		m_modified = true;
+		return false;
+	}
+
+	if (formatCtx->nb_streams == 0 || it->formatName != formatCtx->iformat->name || it->streams.count() != (int)formatCtx->nb_streams)
+		return false;
+
+	for (unsigned i = 0; i < formatCtx->nb_streams; ++i)
+	{
+		const AVStream *stream = formatCtx->streams[i];
+		const AVCodecParameters *codecpar = stream->codecpar;
+		const StreamParams &sp = it->streams.at(i);
+		if (codecpar->codec_type != sp.codecType || codecpar->codec_id != sp.codecId)
+			return false;
+		if (stream->time_base.num != sp.timeBaseNum || stream->time_base.den != sp.timeBaseDen)
+			return false;
+		switch (codecpar->codec_type)
+		{
+			case AVMEDIA_TYPE_VIDEO:
+			case AVMEDIA_TYPE_AUDIO:
+			case AVMEDIA_TYPE_SUBTITLE:
+				if (codecpar->codec_id == AV_CODEC_ID_NONE) //Must be probed
+					return false;
+				break;
+			default:
+				break;
+		}
+	}
+
+	for (unsigned i = 0; i < formatCtx->nb_streams; ++i)
+	{
+		AVStream *stream = formatCtx->streams[i];
+		AVCodecParameters *codecpar = stream->codecpar;
+		const StreamParams &sp = it->streams.at(i);
+
+		codecpar->codec_tag = sp.codecTag;
+		codecpar->format = sp.format;
+		codecpar->bit_rate = sp.bitRate;
+		codecpar->bits_per_coded_sample = sp.bitsPerCodedSample;
+		codecpar->bits_per_raw_sample = sp.bitsPerRawSample;
+		codecpar->profile = sp.profile;
+		codecpar->level = sp.level;
+		codecpar->width = sp.width;
+		codecpar->height = sp.height;
+		codecpar->sample_aspect_ratio = {sp.sarNum, sp.sarDen};
+		codecpar->field_order = (AVFieldOrder)sp.fieldOrder;
+		codecpar->color_range = (AVColorRange)sp.colorRange;
+		codecpar->color_primaries = (AVColorPrimaries)sp.colorPrimaries;
+		codecpar->color_trc = (AVColorTransferCharacteristic)sp.colorTrc;
+		codecpar->color_space = (AVColorSpace)sp.colorSpace;
+		codecpar->chroma_location = (AVChromaLocation)sp.chromaLocation;
+		codecpar->video_delay = sp.videoDelay;
+		codecpar->initial_padding = sp.initialPadding;
+		codecpar->trailing_padding = sp.trailingPadding;
+		codecpar->seek_preroll = sp.seekPreroll;
+		codecpar->channel_layout = sp.channelLayout;
+		codecpar->channels = sp.channels;
+		codecpar->sample_rate = sp.sampleRate;
+		codecpar->block_align = sp.blockAlign;
+		codecpar->frame_size = sp.frameSize;
+		if (codecpar->extradata_size <= 0 && !sp.extradata.isEmpty())
+		{
+			codecpar->extradata = (uint8_t *)av_mallocz(sp.extradata.size() + AV_INPUT_BUFFER_PADDING_SIZE);
+			if (codecpar->extradata)
+			{
+				memcpy(codecpar->extradata, sp.extradata.constData(), sp.extradata.size());
+				codecpar->extradata_size = sp.extradata.size();
+			}
+		}
+
+		stream->r_frame_rate = {sp.rFrameRateNum, sp.rFrameRateDen};
+		stream->avg_frame_rate = {sp.avgFrameRateNum, sp.avgFrameRateDen};
+		stream->sample_aspect_ratio = {sp.streamSarNum, sp.streamSarDen};
+		stream->start_time = sp.startTime;
+		stream->duration = sp.duration;
+		stream->codec_info_nb_frames = sp.codecInfoNbFrames;
+	}
+
+	formatCtx->start_time = it->startTime;
+	formatCtx->duration = it->duration;
+	formatCtx->bit_rate = it->bitRate;
+
+	it->used = true;
+	return true;
+}
+void ProbeCache::insert(const QString &filePath, const FileId &fileId, const AVFormatContext *formatCtx)
+{
+	Entry entry;
+	entry.fileId = fileId;
+	entry.formatName = formatCtx->iformat->name;
+	entry.startTime = formatCtx->start_time;
+	entry.duration = formatCtx->duration;
+	entry.bitRate = formatCtx->bit_rate;
+	entry.streams.reserve(formatCtx->nb_streams);
+	for (unsigned i = 0; i < formatCtx->nb_streams; ++i)
+	{
+		const AVStream *stream = formatCtx->streams[i];
+		const AVCodecParameters *codecpar = stream->codecpar;
+		StreamParams sp;
+		sp.codecType = codecpar->codec_type;
+		sp.codecId = codecpar->codec_id;
+		sp.codecTag = codecpar->codec_tag;
+		sp.format = codecpar->format;
+		sp.bitRate = codecpar->bit_rate;
+		sp.bitsPerCodedSample = codecpar->bits_per_coded_sample;
+		sp.bitsPerRawSample = codecpar->bits_per_raw_sample;
+		sp.profile = codecpar->profile;
+		sp.level = codecpar->level;
+		sp.width = codecpar->width;
+		sp.height = codecpar->height;
+		sp.sarNum = codecpar->sample_aspect_ratio.num;
+		sp.sarDen = codecpar->sample_aspect_ratio.den;
+		sp.fieldOrder = codecpar->field_order;
+		sp.colorRange = codecpar->color_range;
+		sp.colorPrimaries = codecpar->color_primaries;
+		sp.colorTrc = codecpar->color_trc;
+		sp.colorSpace = codecpar->color_space;
+		sp.chromaLocation = codecpar->chroma_location;
+		sp.videoDelay = codecpar->video_delay;
+		sp.initialPadding = codecpar->initial_padding;
+		sp.trailingPadding = codecpar->trailing_padding;
+		sp.seekPreroll = codecpar->seek_preroll;
+		sp.channelLayout = codecpar->channel_layout;
+		sp.channels = codecpar->channels;
+		sp.sampleRate = codecpar->sample_rate;
+		sp.blockAlign = codecpar->block_align;
+		sp.frameSize = codecpar->frame_size;
+		if (codecpar->extradata_size > 0)
+			sp.extradata = QByteArray((const char *)codecpar->extradata, codecpar->extradata_size);
+		sp.timeBaseNum = stream->time_base.num;
+		sp.timeBaseDen = stream->time_base.den;
+		sp.rFrameRateNum = stream->r_frame_rate.num;
+		sp.rFrameRateDen = stream->r_frame_rate.den;
+		sp.avgFrameRateNum = stream->avg_frame_rate.num;
+		sp.avgFrameRateDen = stream->avg_frame_rate.den;
+		sp.streamSarNum = stream->sample_aspect_ratio.num;
+		sp.streamSarDen = stream->sample_aspect_ratio.den;
+		sp.startTime = stream->start_time;
+		sp.duration = stream->duration;
+		sp.codecInfoNbFrames = stream->codec_info_nb_frames;
+		entry.streams += sp;
+	}
+	entry.used = true;
+
+	QMutexLocker locker(&m_mutex);
+	load();
+	m_entries[filePath] = entry;
+	m_modified = true;
+}
+
+void ProbeCache::load()
+{
+	if (m_loaded)
+		return;
+	m_loaded = true;
+
+	QFile file(m_cacheFilePath);
+	if (!file.open(QFile::ReadOnly))
+		return;
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_6);
+
+	quint32 magic = 0, version = 0, count = 0;
+	stream >> magic >> version >> count;
+	if (magic != g_magic || version != g_version)
+		return;
+
+	m_entries.reserve(qMin<quint32>(count, g_maxEntries));
+	for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+	{
+		QString filePath;
+		Entry entry;
+		quint32 streamsCount = 0;
+		stream >> filePath >> entry.fileId.size >> entry.fileId.mTime >> entry.fileId.hash;
+		stream >> entry.formatName >> entry.startTime >> entry.duration >> entry.bitRate >> streamsCount;
+		for (quint32 s = 0; s < streamsCount && stream.status() == QDataStream::Ok; ++s)
+		{
+			StreamParams sp;
+			stream >> sp.codecType >> sp.codecId >> sp.codecTag >> sp.format >> sp.bitRate;
+			stream >> sp.bitsPerCodedSample >> sp.bitsPerRawSample >> sp.profile >> sp.level;
+			stream >> sp.width >> sp.height >> sp.sarNum >> sp.sarDen;
+			stream >> sp.fieldOrder >> sp.colorRange >> sp.colorPrimaries >> sp.colorTrc >> sp.colorSpace >> sp.chromaLocation;
+			stream >> sp.videoDelay >> sp.initialPadding >> sp.trailingPadding >> sp.seekPreroll;
+			stream >> sp.channelLayout >> sp.channels >> sp.sampleRate >> sp.blockAlign >> sp.frameSize;
+			stream >> sp.extradata >> sp.timeBaseNum >> sp.timeBaseDen;
+			stream >> sp.rFrameRateNum >> sp.rFrameRateDen >> sp.avgFrameRateNum >> sp.avgFrameRateDen;
+			stream >> sp.streamSarNum >> sp.streamSarDen >> sp.startTime >> sp.duration >> sp.codecInfoNbFrames;
+			entry.streams += sp;
+		}
+		entry.used = false;
+		if (stream.status() == QDataStream::Ok)
+			m_entries.insert(filePath, entry);
+	}
+}
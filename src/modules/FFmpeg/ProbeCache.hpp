@@ -0,0 +1,123 @@
+/*
+	QMPlay2 is a video and audio player.
+	Copyright (C) 2010-2018  Błażej Szczygieł
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU Lesser General Public License as published
+	by the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QVector>
+#include <QMutex>
+#include <QHash>
+
+struct AVFormatContext;
+class Settings;
+
+/*
+ * Limits for "avformat_find_stream_info()", separately for local files and for network streams.
+ * Format specific limits (e.g. "mpegts=1024:500") override them, 0 means FFmpeg default.
+ */
+class ProbeBudgets
+{
+public:
+	struct Budget
+	{
+		qint64 probeSize = 0;       //Bytes
+		qint64 analyzeDuration = 0; //Microseconds
+	};
+
+	void load(Settings &sets);
+
+	Budget get(bool isLocal, const char *formatName) const;
+
+	void apply(AVFormatContext *formatCtx, bool isLocal) const;
+
+private:
+	Budget m_local, m_network;
+	QHash<QByteArray, Budget> m_formats;
+};
+
+/**/
+
+/*
+ * Streams parameters of local files found by "avformat_find_stream_info()", stored on disk between sessions.
+ * An entry is valid only while the file has the same size, modification time and hash of its beginning,
+ * and only if the streams found in file header have the same codecs as the stored ones. Only formats
+ * whose header describes all streams are cached (e.g. not MPEG-TS/PS, where streams can be found later).
+ * Every new entry is written to disk immediately.
+ */
+class ProbeCache
+{
+	Q_DISABLE_COPY(ProbeCache)
+
+public:
+	ProbeCache();
+	~ProbeCache();
+
+	//Thread-safe, restores streams parameters or calls "avformat_find_stream_info()" and stores them
+	bool findStreamInfo(const QString &filePath, AVFormatContext *formatCtx);
+
+	void save();
+
+private:
+	struct FileId
+	{
+		qint64 size, mTime;
+		QByteArray hash;
+	};
+	struct StreamParams
+	{
+		qint32 codecType, codecId;
+		quint32 codecTag;
+		qint32 format;
+		qint64 bitRate;
+		qint32 bitsPerCodedSample, bitsPerRawSample;
+		qint32 profile, level;
+		qint32 width, height;
+		qint32 sarNum, sarDen;
+		qint32 fieldOrder, colorRange, colorPrimaries, colorTrc, colorSpace, chromaLocation;
+		qint32 videoDelay, initialPadding, trailingPadding, seekPreroll;
+		quint64 channelLayout;
+		qint32 channels, sampleRate, blockAlign, frameSize;
+		QByteArray extradata;
+		qint32 timeBaseNum, timeBaseDen;
+		qint32 rFrameRateNum, rFrameRateDen;
+		qint32 avgFrameRateNum, avgFrameRateDen;
+		qint32 streamSarNum, streamSarDen;
+		qint64 startTime, duration;
+		qint32 codecInfoNbFrames; //Used by "av_find_best_stream()"
+	};
+	struct Entry
+	{
+		FileId fileId;
+		QByteArray formatName;
+		qint64 startTime, duration, bitRate;
+		QVector<StreamParams> streams;
+		bool used;
+	};
+
+	static bool isCacheable(const AVFormatContext *formatCtx);
+	static bool getFileId(const QString &filePath, FileId &fileId);
+
+	bool restore(const QString &filePath, const FileId &fileId, AVFormatContext *formatCtx);
+	void insert(const QString &filePath, const FileId &fileId, const AVFormatContext *formatCtx);
+
+	void load();
+
+	const QString m_cacheFilePath;
+	QMutex m_mutex;
+	QHash<QString, Entry> m_entries;
+	bool m_loaded = false, m_modified = false;
+};
@@ -0,0 +1,296 @@
+/*
+	QMPlay2 is a video and audio player.
+	Copyright (C) 2010-2018  Błażej Szczygieł
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU Lesser General Public License as published
+	by the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <ReadaheadIO.hpp>
+
+extern "C"
+{
+	#include <libavformat/avio.h>
+}
+
+#ifdef Q_OS_UNIX
+	#include <fcntl.h>
+#endif
+
+#include <cstring>
+
+static constexpr int g_avioBufferSize = 32 * 1024;
+static constexpr qint64 g_adviseWindow = 8 * 1024 * 1024; //Local file part read ahead by the kernel
+static constexpr int g_ringSize = 32 * 1024 * 1024;
+static constexpr int g_keepBehind = 1024 * 1024; //For short backward seeks without the network
+static constexpr int g_chunkSize = 64 * 1024;
+
+/**/
+
+ReadaheadIO::ReadaheadIO(const std::shared_ptr<AbortContext> &abortCtx) :
+	pb(nullptr),
+	m_abortCtx(abortCtx),
+	m_quit(false),
+	m_pos(0), m_size(-1), m_advisedPos(0),
+	m_io(nullptr),
+	m_readIdx(0),
+	m_filled(0), m_behind(0),
+	m_seekPos(-1),
+	m_seekResult(0),
+	m_eof(false),
+	m_error(0)
+{}
+ReadaheadIO::~ReadaheadIO()
+{
+	{
+		QMutexLocker locker(&m_mutex);
+		m_quit = true;
+		m_spaceCond.wakeOne();
+	}
+	wait();
+	if (pb && pb != m_io)
+	{
+		av_free(pb->buffer);
+		av_free(pb);
+	}
+	if (m_io)
+		avio_close(m_io);
+}
+
+bool ReadaheadIO::openFile(const QString &filePath)
+{
+	m_file.setFileName(filePath);
+	if (!m_file.open(QFile::ReadOnly | QFile::Unbuffered)) //"AVIOContext" has its own buffer
+		return false;
+
+#if defined(Q_OS_UNIX) && defined(POSIX_FADV_SEQUENTIAL)
+	posix_fadvise(m_file.handle(), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+	pb = avio_alloc_context((quint8 *)av_malloc(g_avioBufferSize), g_avioBufferSize, false, this, readFile, nullptr, seekFile);
+	return pb;
+}
+bool ReadaheadIO::openNetwork(const QByteArray &url, AVDictionary **options)
+{
+	const AVIOInterruptCB avioInterruptCB = {(int(*)(void *))interruptCB, this};
+	if (avio_open2(&m_io, url, AVIO_FLAG_READ, &avioInterruptCB, options) < 0)
+		return false;
+
+	if ((m_io->seekable & AVIO_SEEKABLE_NORMAL) && (m_size = avio_size(m_io)) > 0)
+	{
+		m_pos = avio_tell(m_io);
+		m_buffer.resize(g_ringSize);
+		pb = avio_alloc_context((quint8 *)av_malloc(g_avioBufferSize), g_avioBufferSize, false, this, readNetwork, nullptr, seekNetwork);
+		if (pb)
+		{
+			start();
+			return true;
+		}
+	}
+
+	pb = m_io; //Live stream
+	return true;
+}
+
+int ReadaheadIO::interruptCB(ReadaheadIO *readahead)
+{
+	return readahead->m_quit || readahead->m_abortCtx->isAborted;
+}
+
+int ReadaheadIO::readFile(void *opaque, uint8_t *buf, int bufSize)
+{
+	ReadaheadIO *readahead = (ReadaheadIO *)opaque;
+	if (readahead->m_abortCtx->isAborted)
+		return AVERROR_EXIT;
+
+	readahead->adviseReadahead();
+	const qint64 size = readahead->m_file.read((char *)buf, bufSize); //Reads data appended since the previous EOF
+	if (size < 0)
+		return AVERROR(EIO);
+	if (size == 0)
+		return AVERROR_EOF;
+	readahead->m_pos += size;
+	return size;
+}
+int64_t ReadaheadIO::seekFile(void *opaque, int64_t offset, int whence)
+{
+	ReadaheadIO *readahead = (ReadaheadIO *)opaque;
+	switch (whence & ~AVSEEK_FORCE)
+	{
+		case SEEK_SET:
+			break;
+		case SEEK_CUR:
+			offset += readahead->m_pos;
+			break;
+		case SEEK_END:
+			offset += readahead->m_file.size();
+			break;
+		case AVSEEK_SIZE:
+			return readahead->m_file.size();
+		default:
+			return AVERROR(EINVAL);
+	}
+	if (offset < 0)
+		return AVERROR(EINVAL);
+	if (!readahead->m_file.seek(offset))
+		return AVERROR(EIO);
+	readahead->m_pos = offset;
+	readahead->m_advisedPos = 0; //Advise again from the new position
+	return offset;
+}
+
+int ReadaheadIO::readNetwork(void *opaque, uint8_t *buf, int bufSize)
+{
+	ReadaheadIO *readahead = (ReadaheadIO *)opaque;
+	QMutexLocker locker(&readahead->m_mutex);
+
+	while (readahead->m_filled == 0 && !readahead->m_eof && !readahead->m_error)
+	{
+		if (readahead->m_abortCtx->isAborted)
+			return AVERROR_EXIT;
+		readahead->m_dataCond.wait(&readahead->m_mutex, 100);
+	}
+	if (readahead->m_filled == 0)
+		return readahead->m_error ? readahead->m_error : AVERROR_EOF;
+
+	const int ringSize = readahead->m_buffer.size();
+	const int size = qMin(bufSize, readahead->m_filled);
+	const int firstPart = qMin(size, ringSize - readahead->m_readIdx);
+	memcpy(buf, readahead->m_buffer.constData() + readahead->m_readIdx, firstPart);
+	memcpy(buf + firstPart, readahead->m_buffer.constData(), size - firstPart);
+
+	readahead->m_readIdx = (readahead->m_readIdx + size) % ringSize;
+	readahead->m_filled -= size;
+	readahead->m_behind = qMin(readahead->m_behind + size, ringSize - readahead->m_filled);
+	readahead->m_pos += size;
+
+	readahead->m_spaceCond.wakeOne();
+	return size;
+}
+int64_t ReadaheadIO::seekNetwork(void *opaque, int64_t offset, int whence)
+{
+	ReadaheadIO *readahead = (ReadaheadIO *)opaque;
+	QMutexLocker locker(&readahead->m_mutex);
+
+	switch (whence & ~AVSEEK_FORCE)
+	{
+		case SEEK_SET:
+			break;
+		case SEEK_CUR:
+			offset += readahead->m_pos;
+			break;
+		case SEEK_END:
+			offset += readahead->m_size;
+			break;
+		case AVSEEK_SIZE:
+			return readahead->m_size;
+		default:
+			return AVERROR(EINVAL);
+	}
+	if (offset < 0)
+		return AVERROR(EINVAL);
+
+	const qint64 delta = offset - readahead->m_pos;
+	if (delta >= -readahead->m_behind && delta <= readahead->m_filled)
+	{
+		//Data is in the buffer
+		const int ringSize = readahead->m_buffer.size();
+		readahead->m_readIdx = (readahead->m_readIdx + (int)delta + ringSize) % ringSize;
+		readahead->m_filled -= delta;
+		readahead->m_behind += delta;
+		readahead->m_pos = offset;
+		readahead->m_spaceCond.wakeOne();
+		return offset;
+	}
+
+	readahead->m_seekPos = offset;
+	readahead->m_spaceCond.wakeOne();
+	while (readahead->m_seekPos >= 0)
+	{
+		if (readahead->m_abortCtx->isAborted)
+			return AVERROR_EXIT;
+		readahead->m_dataCond.wait(&readahead->m_mutex, 100);
+	}
+	if (readahead->m_seekResult < 0)
+		return readahead->m_seekResult;
+	return offset;
+}
+
+void ReadaheadIO::adviseReadahead()
+{
+#if defined(Q_OS_UNIX) && defined(POSIX_FADV_WILLNEED)
+	if (m_pos < m_advisedPos - g_adviseWindow / 2)
+		return;
+	posix_fadvise(m_file.handle(), m_pos, g_adviseWindow, POSIX_FADV_WILLNEED);
+	m_advisedPos = m_pos + g_adviseWindow;
+#endif
+}
+
+void ReadaheadIO::run()
+{
+	QByteArray chunk(g_chunkSize, Qt::Uninitialized);
+	QMutexLocker locker(&m_mutex);
+	while (!m_quit)
+	{
+		if (m_seekPos >= 0)
+		{
+			const qint64 seekPos = m_seekPos;
+			locker.unlock();
+			const int64_t ret = avio_seek(m_io, seekPos, SEEK_SET);
+			locker.relock();
+			m_seekResult = (ret < 0) ? ret : 0;
+			m_pos = seekPos;
+			m_readIdx = m_filled = m_behind = 0;
+			m_eof = false;
+			m_error = 0;
+			m_seekPos = -1;
+			m_dataCond.wakeAll();
+			continue;
+		}
+
+		const int ringSize = m_buffer.size();
+		const int space = ringSize - g_keepBehind - m_filled;
+		if (m_eof || m_error || space <= 0)
+		{
+			m_spaceCond.wait(&m_mutex);
+			continue;
+		}
+
+		const int toRead = qMin(g_chunkSize, space);
+		locker.unlock();
+		const int ret = avio_read(m_io, (uint8_t *)chunk.data(), toRead);
+		locker.relock();
+
+		if (m_seekPos >= 0)
+			continue; //Data from before the seek
+
+		if (ret > 0)
+		{
+			const int writeIdx = (m_readIdx + m_filled) % ringSize;
+			const int firstPart = qMin(ret, ringSize - writeIdx);
+			memcpy(m_buffer.data() + writeIdx, chunk.constData(), firstPart);
+			memcpy(m_buffer.data(), chunk.constData() + firstPart, ret - firstPart);
+			m_filled += ret;
+			m_behind = qMin(m_behind, ringSize - m_filled);
+		}
+		else if (ret == 0 || ret == AVERROR_EOF)
+		{
+			m_eof = true;
+		}
+		else
+		{
+			m_error = ret;
+		}
+		m_dataCond.wakeAll();
+	}
+}
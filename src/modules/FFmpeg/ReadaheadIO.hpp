@@ -0,0 +1,82 @@
+/*
+	QMPlay2 is a video and audio player.
+	Copyright (C) 2010-2018  Błażej Szczygieł
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU Lesser General Public License as published
+	by the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <OpenThr.hpp>
+
+#include <QByteArray>
+#include <QFile>
+
+#include <cstdint>
+#include <atomic>
+
+struct AVIOContext;
+
+/*
+ * Input for "AVFormatContext" which doesn't make the demuxer wait for disk or network while data is already available.
+ *
+ * Local files are read directly and the kernel is asked to read ahead the part after the current position.
+ * They aren't memory mapped, so files which are still being written can be played and truncated files
+ * cause a read error instead of "SIGBUS".
+ * Seekable network streams are read by a separate thread into a ring buffer, seeks within the buffer are
+ * done without the network. Live streams use the opened "AVIOContext" directly, so e.g. ICY metadata works.
+ */
+class ReadaheadIO final : public QThread
+{
+public:
+	ReadaheadIO(const std::shared_ptr<AbortContext> &abortCtx);
+	~ReadaheadIO();
+
+	bool openFile(const QString &filePath);
+	bool openNetwork(const QByteArray &url, AVDictionary **options); //Blocking, use in the open thread
+
+	AVIOContext *pb;
+
+private:
+	static int interruptCB(ReadaheadIO *readahead);
+
+	static int readFile(void *opaque, uint8_t *buf, int bufSize);
+	static int64_t seekFile(void *opaque, int64_t offset, int whence);
+
+	static int readNetwork(void *opaque, uint8_t *buf, int bufSize);
+	static int64_t seekNetwork(void *opaque, int64_t offset, int whence);
+
+	void adviseReadahead();
+
+	void run() override;
+
+	std::shared_ptr<AbortContext> m_abortCtx;
+	std::atomic_bool m_quit;
+
+	/* Local file */
+	QFile m_file;
+	qint64 m_pos, m_size, m_advisedPos; //"m_size" is used only by network stream, file size can change
+
+	/* Network stream */
+	AVIOContext *m_io;
+	QMutex m_mutex;
+	QWaitCondition m_dataCond, m_spaceCond;
+	QByteArray m_buffer;
+	int m_readIdx;               //Position of "m_pos" in the ring buffer
+	int m_filled, m_behind;      //Bytes after and before "m_pos" in the ring buffer
+	qint64 m_seekPos;            //Requested seek for the thread, -1 if none
+	int m_seekResult;
+	bool m_eof;
+	int m_error;
+};
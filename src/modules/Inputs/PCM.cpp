@@ -18,6 +18,7 @@
 
 #include <PCM.hpp>
 
+#include <SampleConvert.hpp>
 #include <ByteArray.hpp>
 #include <Packet.hpp>
 #include <Reader.hpp>
@@ -92,31 +93,45 @@ bool PCM::read(Packet &decoded, int &idx)
 	decoded.resize(samples_with_channels * sizeof(float));
 	float *decoded_data = (float *)decoded.data();
 	ByteArray data(dataBA.constData(), dataBA.size(), bigEndian);
+	const bool nativeByteOrder = (bigEndian == (Q_BYTE_ORDER == Q_BIG_ENDIAN));
 	switch (fmt)
 	{
 		case PCM_U8:
-			for (int i = 0; i < samples_with_channels; i++)
-				decoded_data[i] = (data.getBYTE() - 0x7F) / 128.0f;
+			SampleConvert::u8ToFloat(decoded_data, (const quint8 *)dataBA.constData(), samples_with_channels);
 			break;
 		case PCM_S8:
-			for (int i = 0; i < samples_with_channels; i++)
-				decoded_data[i] = (qint8)data.getBYTE() / 128.0f;
+			SampleConvert::s8ToFloat(decoded_data, (const qint8 *)dataBA.constData(), samples_with_channels);
 			break;
 		case PCM_S16:
-			for (int i = 0; i < samples_with_channels; i++)
-				decoded_data[i] = (qint16)data.getWORD() / 32768.0f;
+			if (nativeByteOrder)
+				SampleConvert::s16ToFloat(decoded_data, (const qint16 *)dataBA.constData(), samples_with_channels);
+			else
+			{
+				for (int i = 0; i < samples_with_channels; i++)
+					decoded_data[i] = (qint16)data.getWORD() / 32768.0f;
+			}
 			break;
 		case PCM_S24:
 			for (int i = 0; i < samples_with_channels; i++)
 				decoded_data[i] = (qint32)data.get24bAs32b() / 2147483648.0f;
 			break;
 		case PCM_S32:
-			for (int i = 0; i < samples_with_channels; i++)
-				decoded_data[i] = (qint32)data.getDWORD() / 2147483648.0f;
+			if (nativeByteOrder)
+				SampleConvert::s32ToFloat(decoded_data, (const qint32 *)dataBA.constData(), samples_with_channels);
+			else
+			{
+				for (int i = 0; i < samples_with_channels; i++)
+					decoded_data[i] = (qint32)data.getDWORD() / 2147483648.0f;
+			}
 			break;
 		case PCM_FLT:
-			for (int i = 0; i < samples_with_channels; i++)
-				decoded_data[i] = data.getFloat();
+			if (nativeByteOrder)
+				memcpy(decoded_data, dataBA.constData(), samples_with_channels * sizeof(float));
+			else
+			{
+				for (int i = 0; i < samples_with_channels; i++)
+					decoded_data[i] = data.getFloat();
+			}
 			break;
 		default:
 			break;
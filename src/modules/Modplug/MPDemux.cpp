@@ -18,6 +18,7 @@
 
 #include <MPDemux.hpp>
 
+#include <SampleConvert.hpp>
 #include <Functions.hpp>
 #include <Packet.hpp>
 #include <Reader.hpp>
@@ -155,9 +156,7 @@ bool MPDemux::read(Packet &decoded, int &idx)
 
 	//Konwersja 32bit-int na 32bit-float
 	float *decodedFloat = (float *)decoded.data();
-	const int *decodedInt = (const int *)decodedFloat;
-	for (unsigned i = 0; i < decoded.size() / sizeof(float); ++i)
-		decodedFloat[i] = decodedInt[i] / 2147483648.0;
+	SampleConvert::s32ToFloat(decodedFloat, (const qint32 *)decodedFloat, decoded.size() / sizeof(float));
 
 	idx = 0;
 	decoded.ts = pos;
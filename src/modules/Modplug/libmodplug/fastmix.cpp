@@ -7,33 +7,14 @@
 
 #include "stdafx.hpp"
 #include "sndfile.hpp"
+#include <string.h>
 #include <math.h>
 
-namespace QMPlay2ModPlug {
-
-// Front Mix Buffer (Also room for interleaved rear mix)
-int MixSoundBuffer[MIXBUFFERSIZE*4];
-
-// Reverb Mix Buffer
-#ifndef MODPLUG_NO_REVERB
-int MixReverbBuffer[MIXBUFFERSIZE*2];
-extern UINT gnReverbSend;
-#endif
-
-#ifndef MODPLUG_FASTSOUNDLIB
-int MixRearBuffer[MIXBUFFERSIZE*2];
-float MixFloatBuffer[MIXBUFFERSIZE*2];
-#endif
-
-#ifdef MSC_VER
-#pragma bss_seg()
+#ifdef __SSE2__
+	#include <emmintrin.h>
 #endif
 
-
-extern LONG gnDryROfsVol;
-extern LONG gnDryLOfsVol;
-extern LONG gnRvbROfsVol;
-extern LONG gnRvbLOfsVol;
+namespace QMPlay2ModPlug {
 
 // 4x256 taps polyphase FIR resampling filter
 extern short int gFastSinc[];
@@ -490,6 +471,125 @@ CzWINDOWEDFIR sfir;
 	   vol2_r += (CzWINDOWEDFIR::lut[firidx+7]*(int)p[(poshi+8-4)*2+1]);    \
    int vol_r   = ((vol1_r>>1)+(vol2_r>>1)) >> (WFIR_16BITSHIFT-1);
 
+/////////////////////////////////////////////////////////////////////////////
+// SSE2 spline and FIR interpolation: pmaddwd multiplies 16-bit samples by 16-bit
+// coefficients and sums pairs of products, so results are the same as above
+
+#ifdef __SSE2__
+
+// Sign-extends 8 samples
+static inline __m128i SSE2_Extend8(__m128i x)
+{
+	return _mm_srai_epi16(_mm_unpacklo_epi8(x, x), 8);
+}
+
+// Splits 4 interleaved stereo samples into [L0 L1 L2 L3 R0 R1 R2 R3]
+static inline __m128i SSE2_Deinterleave(__m128i x)
+{
+	x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(3, 1, 2, 0));
+	x = _mm_shufflehi_epi16(x, _MM_SHUFFLE(3, 1, 2, 0));
+	return _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+// 8 taps, sums of the first and the second half
+static inline void SSE2_Fir(__m128i smp, const signed short *lut, int &vol1, int &vol2)
+{
+	__m128i m = _mm_madd_epi16(smp, _mm_loadu_si128((const __m128i *)lut));
+	m = _mm_add_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+	vol1 = _mm_cvtsi128_si32(m);
+	vol2 = _mm_cvtsi128_si32(_mm_shuffle_epi32(m, _MM_SHUFFLE(2, 2, 2, 2)));
+}
+static inline void SSE2_StereoFir(__m128i lo, __m128i hi, const signed short *lut, int &vol1_l, int &vol2_l, int &vol1_r, int &vol2_r)
+{
+	lo = SSE2_Deinterleave(lo);
+	hi = SSE2_Deinterleave(hi);
+	SSE2_Fir(_mm_unpacklo_epi64(lo, hi), lut, vol1_l, vol2_l);
+	SSE2_Fir(_mm_unpackhi_epi64(lo, hi), lut, vol1_r, vol2_r);
+}
+
+// 4 taps, "smp" contains [L0 L1 L2 L3 R0 R1 R2 R3] or mono samples in the lower half
+static inline __m128i SSE2_Spline(__m128i smp, const signed short *lut)
+{
+	const __m128i coef = _mm_loadl_epi64((const __m128i *)lut);
+	const __m128i m = _mm_madd_epi16(smp, _mm_unpacklo_epi64(coef, coef));
+	return _mm_add_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+static inline int SSE2_Load4x8(const signed char *p)
+{
+	int x;
+	memcpy(&x, p, sizeof(x));
+	return x;
+}
+
+#undef SNDMIX_GETMONOVOL8SPLINE
+#define SNDMIX_GETMONOVOL8SPLINE \
+	int poshi	= nPos >> 16; \
+	int poslo	= (nPos >> SPLINE_FRACSHIFT) & SPLINE_FRACMASK; \
+	int vol		= _mm_cvtsi128_si32(SSE2_Spline(SSE2_Extend8(_mm_cvtsi32_si128(SSE2_Load4x8(p+poshi-1))), CzCUBICSPLINE::lut+poslo)) >> SPLINE_8SHIFT;
+
+#undef SNDMIX_GETMONOVOL16SPLINE
+#define SNDMIX_GETMONOVOL16SPLINE \
+	int poshi	= nPos >> 16; \
+	int poslo	= (nPos >> SPLINE_FRACSHIFT) & SPLINE_FRACMASK; \
+	int vol		= _mm_cvtsi128_si32(SSE2_Spline(_mm_loadl_epi64((const __m128i *)(p+poshi-1)), CzCUBICSPLINE::lut+poslo)) >> SPLINE_16SHIFT;
+
+#undef SNDMIX_GETMONOVOL8FIRFILTER
+#define SNDMIX_GETMONOVOL8FIRFILTER \
+	int poshi  = nPos >> 16;\
+	int poslo  = (nPos & 0xFFFF);\
+	int firidx = ((poslo+WFIR_FRACHALVE)>>WFIR_FRACSHIFT) & WFIR_FRACMASK; \
+	int vol1, vol2;\
+	SSE2_Fir(SSE2_Extend8(_mm_loadl_epi64((const __m128i *)(p+poshi-3))), CzWINDOWEDFIR::lut+firidx, vol1, vol2);\
+	int vol    = (vol1 + vol2) >> WFIR_8SHIFT;
+
+#undef SNDMIX_GETMONOVOL16FIRFILTER
+#define SNDMIX_GETMONOVOL16FIRFILTER \
+	int poshi  = nPos >> 16;\
+	int poslo  = (nPos & 0xFFFF);\
+	int firidx = ((poslo+WFIR_FRACHALVE)>>WFIR_FRACSHIFT) & WFIR_FRACMASK; \
+	int vol1, vol2;\
+	SSE2_Fir(_mm_loadu_si128((const __m128i *)(p+poshi-3)), CzWINDOWEDFIR::lut+firidx, vol1, vol2);\
+	int vol    = ((vol1>>1)+(vol2>>1)) >> (WFIR_16BITSHIFT-1);
+
+#undef SNDMIX_GETSTEREOVOL8SPLINE
+#define SNDMIX_GETSTEREOVOL8SPLINE \
+	int poshi	= nPos >> 16; \
+	int poslo	= (nPos >> SPLINE_FRACSHIFT) & SPLINE_FRACMASK; \
+	__m128i vol_lr = SSE2_Spline(SSE2_Deinterleave(SSE2_Extend8(_mm_loadl_epi64((const __m128i *)(p+(poshi-1)*2)))), CzCUBICSPLINE::lut+poslo); \
+	int vol_l	= _mm_cvtsi128_si32(vol_lr) >> SPLINE_8SHIFT; \
+	int vol_r	= _mm_cvtsi128_si32(_mm_shuffle_epi32(vol_lr, _MM_SHUFFLE(2, 2, 2, 2))) >> SPLINE_8SHIFT;
+
+#undef SNDMIX_GETSTEREOVOL16SPLINE
+#define SNDMIX_GETSTEREOVOL16SPLINE \
+	int poshi	= nPos >> 16; \
+	int poslo	= (nPos >> SPLINE_FRACSHIFT) & SPLINE_FRACMASK; \
+	__m128i vol_lr = SSE2_Spline(SSE2_Deinterleave(_mm_loadu_si128((const __m128i *)(p+(poshi-1)*2))), CzCUBICSPLINE::lut+poslo); \
+	int vol_l	= _mm_cvtsi128_si32(vol_lr) >> SPLINE_16SHIFT; \
+	int vol_r	= _mm_cvtsi128_si32(_mm_shuffle_epi32(vol_lr, _MM_SHUFFLE(2, 2, 2, 2))) >> SPLINE_16SHIFT;
+
+#undef SNDMIX_GETSTEREOVOL8FIRFILTER
+#define SNDMIX_GETSTEREOVOL8FIRFILTER \
+	int poshi   = nPos >> 16;\
+	int poslo   = (nPos & 0xFFFF);\
+	int firidx  = ((poslo+WFIR_FRACHALVE)>>WFIR_FRACSHIFT) & WFIR_FRACMASK; \
+	__m128i smp = _mm_loadu_si128((const __m128i *)(p+(poshi+1-4)*2)); \
+	int vol1_l, vol2_l, vol1_r, vol2_r; \
+	SSE2_StereoFir(SSE2_Extend8(smp), SSE2_Extend8(_mm_unpackhi_epi64(smp, smp)), CzWINDOWEDFIR::lut+firidx, vol1_l, vol2_l, vol1_r, vol2_r); \
+	int vol_l   = (vol1_l + vol2_l) >> WFIR_8SHIFT; \
+	int vol_r   = (vol1_r + vol2_r) >> WFIR_8SHIFT;
+
+#undef SNDMIX_GETSTEREOVOL16FIRFILTER
+#define SNDMIX_GETSTEREOVOL16FIRFILTER \
+	int poshi   = nPos >> 16;\
+	int poslo   = (nPos & 0xFFFF);\
+	int firidx  = ((poslo+WFIR_FRACHALVE)>>WFIR_FRACSHIFT) & WFIR_FRACMASK; \
+	int vol1_l, vol2_l, vol1_r, vol2_r; \
+	SSE2_StereoFir(_mm_loadu_si128((const __m128i *)(p+(poshi+1-4)*2)), _mm_loadu_si128((const __m128i *)(p+(poshi+1-4)*2+8)), CzWINDOWEDFIR::lut+firidx, vol1_l, vol2_l, vol1_r, vol2_r); \
+	int vol_l   = ((vol1_l>>1)+(vol2_l>>1)) >> (WFIR_16BITSHIFT-1); \
+	int vol_r   = ((vol1_r>>1)+(vol2_r>>1)) >> (WFIR_16BITSHIFT-1);
+
+#endif // __SSE2__
+
 /////////////////////////////////////////////////////////////////////////////
 
 #define SNDMIX_STOREMONOVOL\
@@ -2362,7 +2462,6 @@ UINT MPPASMCALL X86_AGC(int *pBuffer, UINT nSamples, UINT nAGC)
 void CSoundFile::ProcessAGC(int count)
 //------------------------------------
 {
-	static DWORD gAGCRecoverCount = 0;
 	UINT agc = X86_AGC(MixSoundBuffer, count, gnAGC);
 	// Some kind custom law, so that the AGC stays quite stable, but slowly
 	// goes back up if the sound level stays below a level inversely
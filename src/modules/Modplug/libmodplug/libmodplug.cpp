@@ -8,13 +8,17 @@
 #include "stdafx.hpp"
 #include "sndfile.hpp"
 
+#include <mutex>
+
 namespace QMPlay2ModPlug {
 
 	struct File
 	{
 		CSoundFile mSoundFile;
+		int mSampleSize;
 	};
 
+	static std::mutex gSettingsMutex;
 	Settings gSettings =
 	{
 		ENABLE_OVERSAMPLING | ENABLE_NOISE_REDUCTION,
@@ -35,59 +39,56 @@ namespace QMPlay2ModPlug {
 		0
 	};
 
-	int gSampleSize;
-
-	static void UpdateSettings(bool updateBasicConfig)
+	static void ApplySettings(CSoundFile &soundFile, const Settings &settings)
 	{
-		if(gSettings.mFlags & ENABLE_REVERB)
+		if(settings.mFlags & ENABLE_REVERB)
 		{
-			CSoundFile::SetReverbParameters(gSettings.mReverbDepth,
-			                                gSettings.mReverbDelay);
+			soundFile.SetReverbParameters(settings.mReverbDepth,
+			                              settings.mReverbDelay);
 		}
 
-		if(gSettings.mFlags & ENABLE_MEGABASS)
+		if(settings.mFlags & ENABLE_MEGABASS)
 		{
-			CSoundFile::SetXBassParameters(gSettings.mBassAmount,
-			                               gSettings.mBassRange);
+			soundFile.SetXBassParameters(settings.mBassAmount,
+			                             settings.mBassRange);
 		}
 		else // modplug seems to ignore the SetWaveConfigEx() setting for bass boost
-			CSoundFile::SetXBassParameters(0, 0);
-
-		if(gSettings.mFlags & ENABLE_SURROUND)
-		{
-			CSoundFile::SetSurroundParameters(gSettings.mSurroundDepth,
-			                                  gSettings.mSurroundDelay);
-		}
+			soundFile.SetXBassParameters(0, 0);
 
-		if(updateBasicConfig)
+		if(settings.mFlags & ENABLE_SURROUND)
 		{
-			CSoundFile::SetWaveConfig(gSettings.mFrequency,
-                                      gSettings.mBits,
-                                      gSettings.mChannels);
-			CSoundFile::SetMixConfig(gSettings.mStereoSeparation,
-                                     gSettings.mMaxMixChannels);
-
-			gSampleSize = gSettings.mBits / 8 * gSettings.mChannels;
+			soundFile.SetSurroundParameters(settings.mSurroundDepth,
+			                                settings.mSurroundDelay);
 		}
 
-		CSoundFile::SetWaveConfigEx(gSettings.mFlags & ENABLE_SURROUND,
-                                    !(gSettings.mFlags & ENABLE_OVERSAMPLING),
-                                    gSettings.mFlags & ENABLE_REVERB,
-                                    true,
-                                    gSettings.mFlags & ENABLE_MEGABASS,
-                                    gSettings.mFlags & ENABLE_NOISE_REDUCTION,
-                                    false);
-		CSoundFile::SetResamplingMode(gSettings.mResamplingMode);
+		soundFile.SetWaveConfig(settings.mFrequency,
+		                        settings.mBits,
+		                        settings.mChannels);
+		soundFile.SetMixConfig(settings.mStereoSeparation,
+		                       settings.mMaxMixChannels);
+
+		soundFile.SetWaveConfigEx(settings.mFlags & ENABLE_SURROUND,
+		                          !(settings.mFlags & ENABLE_OVERSAMPLING),
+		                          settings.mFlags & ENABLE_REVERB,
+		                          true,
+		                          settings.mFlags & ENABLE_MEGABASS,
+		                          settings.mFlags & ENABLE_NOISE_REDUCTION,
+		                          false);
+		soundFile.SetResamplingMode(settings.mResamplingMode);
 	}
 
 
 File* Load(const void* data, int size)
 {
 	File* result = new File;
-	UpdateSettings(true);
+	gSettingsMutex.lock();
+	const Settings settings = gSettings;
+	gSettingsMutex.unlock();
+	ApplySettings(result->mSoundFile, settings);
+	result->mSampleSize = settings.mBits / 8 * settings.mChannels;
 	if(result->mSoundFile.Create((const BYTE*)data, size))
 	{
-		result->mSoundFile.SetRepeatCount(gSettings.mLoopCount);
+		result->mSoundFile.SetRepeatCount(settings.mLoopCount);
 		return result;
 	}
 	else
@@ -105,7 +106,7 @@ void Unload(File* file)
 
 int Read(File* file, void* buffer, int size)
 {
-	return file->mSoundFile.Read(buffer, size) * gSampleSize;
+	return file->mSoundFile.Read(buffer, size) * file->mSampleSize;
 }
 
 const char* GetName(File* file)
@@ -267,13 +268,14 @@ void Seek(File* file, int millisecond)
 
 void GetSettings(Settings* settings)
 {
+	std::lock_guard<std::mutex> locker(gSettingsMutex);
 	memcpy(settings, &gSettings, sizeof(Settings));
 }
 
 void SetSettings(const Settings* settings)
 {
+	std::lock_guard<std::mutex> locker(gSettingsMutex);
 	memcpy(&gSettings, settings, sizeof(Settings));
-	UpdateSettings(false); // do not update basic config.
 }
 
 } //namespace ModPlug
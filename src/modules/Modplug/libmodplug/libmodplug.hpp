@@ -90,9 +90,9 @@ struct Settings
 	                        -1 loops forever. */
 };
 
-/* Get and set the mod decoder settings.  All options, except for channels, bits-per-sample,
- * sampling rate, and loop count, will take effect immediately.  Those options which don't
- * take effect immediately will take effect the next time you load a mod. */
+/* Get and set the mod decoder settings.  Every loaded mod has its own copy of the settings
+ * and its own mixer, so different mods can be rendered concurrently.  The settings will take
+ * effect the next time you load a mod. */
 void GetSettings(Settings* settings);
 void SetSettings(const Settings* settings);
 
@@ -526,24 +526,89 @@ typedef struct MODMIDICFG
 
 typedef VOID (* LPSNDMIXHOOKPROC)(int *, unsigned long, unsigned long); // buffer, samples, channels
 
+// Mixing constants
+#define MIXBUFFERSIZE		512
+#define MIXING_ATTENUATION	4
+#define MIXING_CLIPMIN		(-0x08000000)
+#define MIXING_CLIPMAX		(0x07FFFFFF)
+#define VOLUMERAMPPRECISION	12
+#define FADESONGDELAY		100
+#define EQ_BUFFERSIZE		(MIXBUFFERSIZE)
+#define AGC_PRECISION		9
+#define AGC_UNITY			(1 << AGC_PRECISION)
+
+// DSP effects buffer sizes
+#define XBASS_DELAY			14	// 2.5 ms
+#define XBASSBUFFERSIZE		64		// 2 ms at 50KHz
+#define FILTERBUFFERSIZE	64		// 1.25 ms
+#define SURROUNDBUFFERSIZE	((MAX_SAMPLE_RATE * 50) / 1000)
+#define REVERBBUFFERSIZE	((MAX_SAMPLE_RATE * 200) / 1000)
+#define REVERBBUFFERSIZE2	((REVERBBUFFERSIZE*13) / 17)
+#define REVERBBUFFERSIZE3	((REVERBBUFFERSIZE*7) / 13)
+#define REVERBBUFFERSIZE4	((REVERBBUFFERSIZE*7) / 19)
+
 
 
 //==============
 class CSoundFile
 //==============
 {
-public:	// Static Members
-	static UINT m_nXBassDepth, m_nXBassRange;
-	static UINT m_nReverbDepth, m_nReverbDelay, gnReverbType;
-	static UINT m_nProLogicDepth, m_nProLogicDelay;
-	static UINT m_nStereoSeparation;
-	static UINT m_nMaxMixChannels;
-	static LONG m_nStreamVolume;
-	static DWORD gdwSysInfo, gdwSoundSetup, gdwMixingFreq, gnBitsPerSample, gnChannels;
-	static UINT gnAGC, gnVolumeRampSamples, gnVUMeter, gnCPUUsage;
-	static LPSNDMIXHOOKPROC gpSndMixHook;
+public:	// Mixer configuration, every instance has its own, so files can be rendered concurrently
+	UINT m_nXBassDepth = 6, m_nXBassRange = XBASS_DELAY;
+	UINT m_nReverbDepth = 1, m_nReverbDelay = 100, gnReverbType = 0;
+	UINT m_nProLogicDepth = 12, m_nProLogicDelay = 20;
+	UINT m_nStereoSeparation = 128;
+	UINT m_nMaxMixChannels = 32;
+	LONG m_nStreamVolume = 0x8000;
+	DWORD gdwSysInfo = 0, gdwSoundSetup = 0, gdwMixingFreq = 44100, gnBitsPerSample = 16, gnChannels = 1;
+	UINT gnAGC = AGC_UNITY, gnVolumeRampSamples = 64, gnVUMeter = 0, gnCPUUsage = 0;
+	LPSNDMIXHOOKPROC gpSndMixHook = NULL;
 	static PMIXPLUGINCREATEPROC gpMixPluginCreateProc;
 
+private:	// Mixing buffers and DSP effects state
+	int MixSoundBuffer[MIXBUFFERSIZE*4] = {}; // Front Mix Buffer (Also room for interleaved rear mix)
+#ifndef MODPLUG_NO_REVERB
+	int MixReverbBuffer[MIXBUFFERSIZE*2] = {};
+	UINT gnReverbSend = 0;
+#endif
+	int MixRearBuffer[MIXBUFFERSIZE*2] = {};
+	LONG gnDryROfsVol = 0, gnDryLOfsVol = 0;
+	LONG gnRvbROfsVol = 0, gnRvbLOfsVol = 0;
+	int gbInitPlugins = 0;
+	DWORD gAGCRecoverCount = 0;
+
+	// Bass Expansion: low-pass filter
+	LONG nXBassSum = 0, nXBassBufferPos = 0, nXBassDlyPos = 0, nXBassMask = 0;
+	LONG XBassBuffer[XBASSBUFFERSIZE] = {};
+	LONG XBassDelay[XBASSBUFFERSIZE] = {};
+	// Noise Reduction: simple low-pass filter
+	LONG nLeftNR = 0, nRightNR = 0;
+	// Surround Encoding: 1 delay line + low-pass filter + high-pass filter
+	LONG nSurroundSize = 0, nSurroundPos = 0, nDolbyDepth = 0;
+	LONG nDolbyLoDlyPos = 0, nDolbyLoFltPos = 0, nDolbyLoFltSum = 0;
+	LONG nDolbyHiFltPos = 0, nDolbyHiFltSum = 0;
+	LONG DolbyLoFilterBuffer[XBASSBUFFERSIZE] = {};
+	LONG DolbyLoFilterDelay[XBASSBUFFERSIZE] = {};
+	LONG DolbyHiFilterBuffer[FILTERBUFFERSIZE] = {};
+	LONG SurroundBuffer[SURROUNDBUFFERSIZE] = {};
+#ifndef MODPLUG_NO_REVERB
+	// Reverb: 4 delay lines + high-pass filter + low-pass filter
+	LONG nReverbSize = 0, nReverbBufferPos = 0;
+	LONG nReverbSize2 = 0, nReverbBufferPos2 = 0;
+	LONG nReverbSize3 = 0, nReverbBufferPos3 = 0;
+	LONG nReverbSize4 = 0, nReverbBufferPos4 = 0;
+	LONG nReverbLoFltSum = 0, nReverbLoFltPos = 0, nReverbLoDlyPos = 0;
+	LONG nFilterAttn = 0;
+	LONG gRvbLowPass[8] = {};
+	LONG gRvbLPPos = 0, gRvbLPSum = 0;
+	LONG ReverbLoFilterBuffer[XBASSBUFFERSIZE] = {};
+	LONG ReverbLoFilterDelay[XBASSBUFFERSIZE] = {};
+	LONG ReverbBuffer[REVERBBUFFERSIZE] = {};
+	LONG ReverbBuffer2[REVERBBUFFERSIZE2] = {};
+	LONG ReverbBuffer3[REVERBBUFFERSIZE3] = {};
+	LONG ReverbBuffer4[REVERBBUFFERSIZE4] = {};
+#endif
+
 public:	// for Editing
 	MODCHANNEL Chn[MAX_CHANNELS];					// Channels
 	UINT ChnMix[MAX_CHANNELS];						// Channels to be mixed
@@ -666,33 +731,33 @@ public:
 
 public:
 	// Mixer Config
-	static BOOL InitPlayer(BOOL bReset=FALSE);
-	static BOOL SetMixConfig(UINT nStereoSeparation, UINT nMaxMixChannels);
-	static BOOL SetWaveConfig(UINT nRate,UINT nBits,UINT nChannels,BOOL bMMX=FALSE);
-	static BOOL SetResamplingMode(UINT nMode); // SRCMODE_XXXX
-	static BOOL IsStereo() { return (gnChannels > 1) ? TRUE : FALSE; }
-	static DWORD GetSampleRate() { return gdwMixingFreq; }
-	static DWORD GetBitsPerSample() { return gnBitsPerSample; }
-	static DWORD InitSysInfo();
-	static DWORD GetSysInfo() { return gdwSysInfo; }
+	BOOL InitPlayer(BOOL bReset=FALSE);
+	BOOL SetMixConfig(UINT nStereoSeparation, UINT nMaxMixChannels);
+	BOOL SetWaveConfig(UINT nRate,UINT nBits,UINT nChannels,BOOL bMMX=FALSE);
+	BOOL SetResamplingMode(UINT nMode); // SRCMODE_XXXX
+	BOOL IsStereo() const { return (gnChannels > 1) ? TRUE : FALSE; }
+	DWORD GetSampleRate() const { return gdwMixingFreq; }
+	DWORD GetBitsPerSample() const { return gnBitsPerSample; }
+	DWORD InitSysInfo();
+	DWORD GetSysInfo() const { return gdwSysInfo; }
 	// AGC
-	static BOOL GetAGC() { return (gdwSoundSetup & SNDMIX_AGC) ? TRUE : FALSE; }
-	static void SetAGC(BOOL b);
-	static void ResetAGC();
-	static void ProcessAGC(int count);
+	BOOL GetAGC() const { return (gdwSoundSetup & SNDMIX_AGC) ? TRUE : FALSE; }
+	void SetAGC(BOOL b);
+	void ResetAGC();
+	void ProcessAGC(int count);
 
 	//GCCFIX -- added these functions back in!
-	static BOOL SetWaveConfigEx(BOOL bSurround,BOOL bNoOverSampling,BOOL bReverb,BOOL hqido,BOOL bMegaBass,BOOL bNR,BOOL bEQ);
+	BOOL SetWaveConfigEx(BOOL bSurround,BOOL bNoOverSampling,BOOL bReverb,BOOL hqido,BOOL bMegaBass,BOOL bNR,BOOL bEQ);
 	// DSP Effects
-	static void InitializeDSP(BOOL bReset);
-	static void ProcessStereoDSP(int count);
-	static void ProcessMonoDSP(int count);
+	void InitializeDSP(BOOL bReset);
+	void ProcessStereoDSP(int count);
+	void ProcessMonoDSP(int count);
 	// [Reverb level 0(quiet)-100(loud)], [delay in ms, usually 40-200ms]
-	static BOOL SetReverbParameters(UINT nDepth, UINT nDelay);
+	BOOL SetReverbParameters(UINT nDepth, UINT nDelay);
 	// [XBass level 0(quiet)-100(loud)], [cutoff in Hz 10-100]
-	static BOOL SetXBassParameters(UINT nDepth, UINT nRange);
+	BOOL SetXBassParameters(UINT nDepth, UINT nRange);
 	// [Surround level 0(quiet)-100(heavy)] [delay in ms, usually 5-40ms]
-	static BOOL SetSurroundParameters(UINT nDepth, UINT nDelay);
+	BOOL SetSurroundParameters(UINT nDepth, UINT nDelay);
 public:
 	BOOL ReadNote();
 	BOOL ProcessRow();
@@ -910,15 +975,6 @@ typedef struct WAVEEXTRAHEADER
 ///////////////////////////////////////////////////////////
 // Low-level Mixing functions
 
-#define MIXBUFFERSIZE		512
-#define MIXING_ATTENUATION	4
-#define MIXING_CLIPMIN		(-0x08000000)
-#define MIXING_CLIPMAX		(0x07FFFFFF)
-#define VOLUMERAMPPRECISION	12
-#define FADESONGDELAY		100
-#define EQ_BUFFERSIZE		(MIXBUFFERSIZE)
-#define AGC_PRECISION		9
-#define AGC_UNITY			(1 << AGC_PRECISION)
 
 // Calling conventions
 #ifdef MSC_VER
@@ -18,8 +18,12 @@
 
 #include <BlendDeint.hpp>
 #include <VideoFilters.hpp>
+#include <WorkerPool.hpp>
 
-BlendDeint::BlendDeint()
+#include <QVector>
+
+BlendDeint::BlendDeint(bool multiThreaded) :
+	m_multiThreaded(multiThreaded)
 {
 	addParam("W");
 	addParam("H");
@@ -33,15 +37,47 @@ bool BlendDeint::filter(QQueue<FrameBuffer> &framesQueue)
 		FrameBuffer dequeued = internalQueue.dequeue();
 		VideoFrame &videoFrame = dequeued.frame;
 		videoFrame.setNoInterlaced();
+		WorkerPool &workerPool = WorkerPool::instance();
+		const int threadsCount = m_multiThreaded ? workerPool.threadsCount() : 1;
 		for (int p = 0; p < 3; ++p)
 		{
 			const int linesize = videoFrame.linesize[p];
 			quint8 *data = videoFrame.buffer[p].data() + linesize;
 			const int h = videoFrame.size.getHeight(p) - 2;
-			for (int i = 0; i < h; ++i)
+			const int jobsCount = qMin(threadsCount * 4, h / 16);
+			if (jobsCount > 1)
+			{
+				/*
+				 * Lines are blended in place with the next line, so the first line of every job
+				 * must be copied before it is overwritten by the job which owns it.
+				 */
+				const int linesPerJob = (h + jobsCount - 1) / jobsCount;
+				QVector<quint8> nextLines((jobsCount - 1) * linesize);
+				for (int j = 1; j < jobsCount; ++j)
+				{
+					const int line = qMin(j * linesPerJob, h);
+					memcpy(nextLines.data() + (j - 1) * linesize, data + line * linesize, linesize);
+				}
+				workerPool.run(jobsCount, [&](int jobId) {
+					const int begin = qMin(jobId * linesPerJob, h);
+					const int end = qMin(begin + linesPerJob, h);
+					quint8 *line = data + begin * linesize;
+					for (int i = begin; i < end; ++i)
+					{
+						const bool lastInJob = (i == end - 1 && end < h);
+						const quint8 *nextLine = lastInJob ? nextLines.constData() + jobId * linesize : line + linesize;
+						VideoFilters::averageTwoLines(line, line, nextLine, linesize);
+						line += linesize;
+					}
+				});
+			}
+			else
 			{
-				VideoFilters::averageTwoLines(data, data, data + linesize, linesize);
-				data += linesize;
+				for (int i = 0; i < h; ++i)
+				{
+					VideoFilters::averageTwoLines(data, data, data + linesize, linesize);
+					data += linesize;
+				}
 			}
 		}
 		framesQueue.enqueue(dequeued);
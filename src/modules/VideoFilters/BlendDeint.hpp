@@ -23,11 +23,14 @@
 class BlendDeint final : public DeintFilter
 {
 public:
-	BlendDeint();
+	BlendDeint(bool multiThreaded);
 
 	bool filter(QQueue<FrameBuffer> &framesQueue) override;
 
 	bool processParams(bool *paramsCorrected) override;
+
+private:
+	const bool m_multiThreaded;
 };
 
 #define BlendDeintName "Blend"
@@ -19,8 +19,10 @@
 #include <MotionBlur.hpp>
 #include <VideoFilters.hpp>
 #include <VideoFrame.hpp>
+#include <WorkerPool.hpp>
 
-MotionBlur::MotionBlur()
+MotionBlur::MotionBlur(bool multiThreaded) :
+	m_multiThreaded(multiThreaded)
 {
 	addParam("W");
 	addParam("H");
@@ -38,20 +40,36 @@ bool MotionBlur::filter(QQueue<FrameBuffer> &framesQueue)
 		VideoFrame videoFrame2(videoFrame1.size, videoFrame1.linesize);
 		const VideoFrame &videoFrame3 = lookup.frame;
 
-		for (int p = 0; p < 3; ++p)
-		{
-			const quint8 *src1 = videoFrame1.buffer[p].data();
-			const quint8 *src2 = videoFrame3.buffer[p].data();
-			quint8 *dest = videoFrame2.buffer[p].data();
+		const auto averageLines = [&](int p, int begin, int end) {
 			const int linesize = videoFrame1.linesize[p];
-			const int h = videoFrame1.size.getHeight(p);
-			for (int i = 0; i < h; ++i)
+			const int offset = begin * linesize;
+			const quint8 *src1 = videoFrame1.buffer[p].data() + offset;
+			const quint8 *src2 = videoFrame3.buffer[p].data() + offset;
+			quint8 *dest = videoFrame2.buffer[p].data() + offset;
+			for (int i = begin; i < end; ++i)
 			{
 				VideoFilters::averageTwoLines(dest, src1, src2, linesize);
 				dest += linesize;
 				src1 += linesize;
 				src2 += linesize;
 			}
+		};
+
+		WorkerPool &workerPool = WorkerPool::instance();
+		const int threadsCount = m_multiThreaded ? workerPool.threadsCount() : 1;
+		for (int p = 0; p < 3; ++p)
+		{
+			const int h = videoFrame1.size.getHeight(p);
+			if (threadsCount > 1)
+			{
+				workerPool.parallelFor(h, qMax(16, h / (threadsCount * 4)), [&](int begin, int end) {
+					averageLines(p, begin, end);
+				});
+			}
+			else
+			{
+				averageLines(p, 0, h);
+			}
 		}
 
 		framesQueue.enqueue(dequeued);
@@ -23,11 +23,14 @@
 class MotionBlur final : public VideoFilter
 {
 public:
-	MotionBlur();
+	MotionBlur(bool multiThreaded);
 
 	bool filter(QQueue<FrameBuffer> &framesQueue) override;
 
 	bool processParams(bool *paramsCorrected) override;
+
+private:
+	const bool m_multiThreaded;
 };
 
 #define MotionBlurName "Motion Blur"
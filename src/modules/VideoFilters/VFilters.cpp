@@ -27,6 +27,8 @@ VFilters::VFilters() :
 	Module("VideoFilters")
 {
 	m_icon = QIcon(":/VideoFilters.svgz");
+
+	init("MultiThreaded", true);
 }
 
 QList<VFilters::Info> VFilters::getModulesInfo(const bool) const
@@ -51,7 +53,7 @@ void *VFilters::createInstance(const QString &name)
 	else if (name == Yadif2xNoSpatialDeintName)
 		return new YadifDeint(true, false);
 	else if (name == BlendDeintName)
-		return new BlendDeint;
+		return new BlendDeint(getBool("MultiThreaded"));
 	else if (name == DiscardDeintName)
 		return new DiscardDeint;
 	else if (name == YadifDeintName)
@@ -59,8 +61,33 @@ void *VFilters::createInstance(const QString &name)
 	else if (name == YadifNoSpatialDeintName)
 		return new YadifDeint(false, false);
 	else if (name == MotionBlurName)
-		return new MotionBlur;
+		return new MotionBlur(getBool("MultiThreaded"));
 	return nullptr;
 }
 
+VFilters::SettingsWidget *VFilters::getSettingsWidget()
+{
+	return new ModuleSettingsWidget(*this);
+}
+
 QMPLAY2_EXPORT_MODULE(VFilters)
+
+/**/
+
+#include <QGridLayout>
+#include <QCheckBox>
+
+ModuleSettingsWidget::ModuleSettingsWidget(Module &module) :
+	Module::SettingsWidget(module)
+{
+	multiThreadedB = new QCheckBox(tr("Use multiple threads for blend deinterlacing and motion blur"));
+	multiThreadedB->setChecked(sets().getBool("MultiThreaded"));
+
+	QGridLayout *layout = new QGridLayout(this);
+	layout->addWidget(multiThreadedB);
+}
+
+void ModuleSettingsWidget::saveSettings()
+{
+	sets().set("MultiThreaded", multiThreadedB->isChecked());
+}
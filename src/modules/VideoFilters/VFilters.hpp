@@ -30,4 +30,21 @@ public:
 private:
 	QList<Info> getModulesInfo(const bool) const override;
 	void *createInstance(const QString &) override;
+
+	SettingsWidget *getSettingsWidget() override;
+};
+
+/**/
+
+class QCheckBox;
+
+class ModuleSettingsWidget final : public Module::SettingsWidget
+{
+	Q_DECLARE_TR_FUNCTIONS(ModuleSettingsWidget)
+public:
+	ModuleSettingsWidget(Module &module);
+private:
+	void saveSettings() override;
+
+	QCheckBox *multiThreadedB;
 };
@@ -29,6 +29,7 @@
 
 #include <YadifDeint.hpp>
 
+#include <WorkerPool.hpp>
 #include <CPU.hpp>
 
 extern "C"
@@ -38,6 +39,13 @@ extern "C"
 
 #include <algorithm>
 
+#ifdef QMPLAY2_CPU_X86
+	#include <immintrin.h>
+	#if defined(AV_CPU_FLAG_AVX512) && (defined(__clang__) || __GNUC__ >= 5)
+		#define QMPLAY2_YADIF_AVX512
+	#endif
+#endif
+
 using std::min;
 using std::max;
 
@@ -396,6 +404,195 @@ static void filterLine_SSE2(quint8 *dest, const void *const destEnd,
 #undef CHECK2
 #undef FILTER
 
+#endif // QMPLAY2_CPU_X86
+
+#ifdef QMPLAY2_CPU_X86
+
+/* Yadif intrinsics, pixels are processed as 16-bit words */
+
+#define QMPLAY2_TARGET(arch) __attribute__((target(arch)))
+
+#define AVX2_LOAD(mem) \
+	_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(mem)))
+
+QMPLAY2_TARGET("avx2")
+static inline __m256i absDiff_AVX2(const __m256i a, const __m256i b)
+{
+	return _mm256_abs_epi16(_mm256_sub_epi16(a, b));
+}
+QMPLAY2_TARGET("avx2")
+static inline __m256i check_AVX2(const quint8 *curr, const qptrdiff prefs, const qptrdiff mrefs, const int j,
+                                 __m256i &spatialScore, __m256i &spatialPred, const __m256i canCheck)
+{
+	const __m256i score = _mm256_add_epi16(_mm256_add_epi16(
+		absDiff_AVX2(AVX2_LOAD(curr + mrefs - 1 + j), AVX2_LOAD(curr + prefs - 1 - j)),
+		absDiff_AVX2(AVX2_LOAD(curr + mrefs     + j), AVX2_LOAD(curr + prefs     - j))),
+		absDiff_AVX2(AVX2_LOAD(curr + mrefs + 1 + j), AVX2_LOAD(curr + prefs + 1 - j))
+	);
+	const __m256i pred = _mm256_srli_epi16(_mm256_add_epi16(AVX2_LOAD(curr + mrefs + j), AVX2_LOAD(curr + prefs - j)), 1);
+	const __m256i mask = _mm256_and_si256(canCheck, _mm256_cmpgt_epi16(spatialScore, score));
+	spatialScore = _mm256_blendv_epi8(spatialScore, score, mask);
+	spatialPred = _mm256_blendv_epi8(spatialPred, pred, mask);
+	return mask;
+}
+QMPLAY2_TARGET("avx2")
+static void filterLine_AVX2(quint8 *dest, const void *const destEnd,
+                            const quint8 *prev, const quint8 *curr, const quint8 *next,
+                            const qptrdiff prefs, const qptrdiff mrefs,
+                            const int spatialCheck, const bool filterParity)
+{
+	const quint8 *prev2 = filterParity ? prev : curr;
+	const quint8 *next2 = filterParity ? curr : next;
+
+	const __m256i allOnes = _mm256_set1_epi16(-1);
+	const __m256i pw1 = _mm256_set1_epi16(1);
+
+	while (dest < destEnd)
+	{
+		const __m256i c = AVX2_LOAD(curr + mrefs);
+		const __m256i e = AVX2_LOAD(curr + prefs);
+		const __m256i p2 = AVX2_LOAD(prev2);
+		const __m256i n2 = AVX2_LOAD(next2);
+		const __m256i d = _mm256_srli_epi16(_mm256_add_epi16(p2, n2), 1);
+
+		const __m256i temporalDiff0 = absDiff_AVX2(p2, n2);
+		const __m256i temporalDiff1 = _mm256_srli_epi16(_mm256_add_epi16(absDiff_AVX2(AVX2_LOAD(prev + mrefs), c), absDiff_AVX2(AVX2_LOAD(prev + prefs), e)), 1);
+		const __m256i temporalDiff2 = _mm256_srli_epi16(_mm256_add_epi16(absDiff_AVX2(AVX2_LOAD(next + mrefs), c), absDiff_AVX2(AVX2_LOAD(next + prefs), e)), 1);
+
+		__m256i diff = _mm256_max_epi16(_mm256_max_epi16(_mm256_srli_epi16(temporalDiff0, 1), temporalDiff1), temporalDiff2);
+		__m256i spatialPred = _mm256_srli_epi16(_mm256_add_epi16(c, e), 1);
+		__m256i spatialScore = _mm256_sub_epi16(_mm256_add_epi16(_mm256_add_epi16(
+			absDiff_AVX2(AVX2_LOAD(curr + mrefs - 1), AVX2_LOAD(curr + prefs - 1)),
+			absDiff_AVX2(c, e)),
+			absDiff_AVX2(AVX2_LOAD(curr + mrefs + 1), AVX2_LOAD(curr + prefs + 1))),
+			pw1
+		);
+
+		check_AVX2(curr, prefs, mrefs, -2, spatialScore, spatialPred, check_AVX2(curr, prefs, mrefs, -1, spatialScore, spatialPred, allOnes));
+		check_AVX2(curr, prefs, mrefs, +2, spatialScore, spatialPred, check_AVX2(curr, prefs, mrefs, +1, spatialScore, spatialPred, allOnes));
+
+		if (spatialCheck)
+		{
+			const __m256i b = _mm256_srli_epi16(_mm256_add_epi16(AVX2_LOAD(prev2 + 2 * mrefs), AVX2_LOAD(next2 + 2 * mrefs)), 1);
+			const __m256i f = _mm256_srli_epi16(_mm256_add_epi16(AVX2_LOAD(prev2 + 2 * prefs), AVX2_LOAD(next2 + 2 * prefs)), 1);
+			const __m256i dMinusE = _mm256_sub_epi16(d, e);
+			const __m256i dMinusC = _mm256_sub_epi16(d, c);
+			const __m256i bMinusC = _mm256_sub_epi16(b, c);
+			const __m256i fMinusE = _mm256_sub_epi16(f, e);
+			const __m256i maxVal = _mm256_max_epi16(_mm256_max_epi16(dMinusE, dMinusC), _mm256_min_epi16(bMinusC, fMinusE));
+			const __m256i minVal = _mm256_min_epi16(_mm256_min_epi16(dMinusE, dMinusC), _mm256_max_epi16(bMinusC, fMinusE));
+			diff = _mm256_max_epi16(_mm256_max_epi16(diff, minVal), _mm256_sub_epi16(_mm256_setzero_si256(), maxVal));
+		}
+
+		spatialPred = _mm256_max_epi16(_mm256_min_epi16(spatialPred, _mm256_add_epi16(d, diff)), _mm256_sub_epi16(d, diff));
+
+		_mm_storeu_si128((__m128i *)dest, _mm_packus_epi16(_mm256_castsi256_si128(spatialPred), _mm256_extracti128_si256(spatialPred, 1)));
+
+		dest  += 16;
+		prev  += 16;
+		curr  += 16;
+		next  += 16;
+		prev2 += 16;
+		next2 += 16;
+	}
+}
+
+#undef AVX2_LOAD
+
+#ifdef QMPLAY2_YADIF_AVX512
+
+#define AVX512_LOAD(mem) \
+	_mm512_cvtepu8_epi16(_mm256_loadu_si256((const __m256i *)(mem)))
+
+QMPLAY2_TARGET("avx512f,avx512bw")
+static inline __m512i absDiff_AVX512(const __m512i a, const __m512i b)
+{
+	return _mm512_abs_epi16(_mm512_sub_epi16(a, b));
+}
+QMPLAY2_TARGET("avx512f,avx512bw")
+static inline __mmask32 check_AVX512(const quint8 *curr, const qptrdiff prefs, const qptrdiff mrefs, const int j,
+                                     __m512i &spatialScore, __m512i &spatialPred, const __mmask32 canCheck)
+{
+	const __m512i score = _mm512_add_epi16(_mm512_add_epi16(
+		absDiff_AVX512(AVX512_LOAD(curr + mrefs - 1 + j), AVX512_LOAD(curr + prefs - 1 - j)),
+		absDiff_AVX512(AVX512_LOAD(curr + mrefs     + j), AVX512_LOAD(curr + prefs     - j))),
+		absDiff_AVX512(AVX512_LOAD(curr + mrefs + 1 + j), AVX512_LOAD(curr + prefs + 1 - j))
+	);
+	const __m512i pred = _mm512_srli_epi16(_mm512_add_epi16(AVX512_LOAD(curr + mrefs + j), AVX512_LOAD(curr + prefs - j)), 1);
+	const __mmask32 mask = _mm512_mask_cmpgt_epi16_mask(canCheck, spatialScore, score);
+	spatialScore = _mm512_mask_blend_epi16(mask, spatialScore, score);
+	spatialPred = _mm512_mask_blend_epi16(mask, spatialPred, pred);
+	return mask;
+}
+QMPLAY2_TARGET("avx512f,avx512bw")
+static void filterLine_AVX512(quint8 *dest, const void *const destEnd,
+                              const quint8 *prev, const quint8 *curr, const quint8 *next,
+                              const qptrdiff prefs, const qptrdiff mrefs,
+                              const int spatialCheck, const bool filterParity)
+{
+	const quint8 *prev2 = filterParity ? prev : curr;
+	const quint8 *next2 = filterParity ? curr : next;
+
+	const __mmask32 allLanes = 0xFFFFFFFF;
+	const __m512i pw1 = _mm512_set1_epi16(1);
+
+	while (dest < destEnd)
+	{
+		const __m512i c = AVX512_LOAD(curr + mrefs);
+		const __m512i e = AVX512_LOAD(curr + prefs);
+		const __m512i p2 = AVX512_LOAD(prev2);
+		const __m512i n2 = AVX512_LOAD(next2);
+		const __m512i d = _mm512_srli_epi16(_mm512_add_epi16(p2, n2), 1);
+
+		const __m512i temporalDiff0 = absDiff_AVX512(p2, n2);
+		const __m512i temporalDiff1 = _mm512_srli_epi16(_mm512_add_epi16(absDiff_AVX512(AVX512_LOAD(prev + mrefs), c), absDiff_AVX512(AVX512_LOAD(prev + prefs), e)), 1);
+		const __m512i temporalDiff2 = _mm512_srli_epi16(_mm512_add_epi16(absDiff_AVX512(AVX512_LOAD(next + mrefs), c), absDiff_AVX512(AVX512_LOAD(next + prefs), e)), 1);
+
+		__m512i diff = _mm512_max_epi16(_mm512_max_epi16(_mm512_srli_epi16(temporalDiff0, 1), temporalDiff1), temporalDiff2);
+		__m512i spatialPred = _mm512_srli_epi16(_mm512_add_epi16(c, e), 1);
+		__m512i spatialScore = _mm512_sub_epi16(_mm512_add_epi16(_mm512_add_epi16(
+			absDiff_AVX512(AVX512_LOAD(curr + mrefs - 1), AVX512_LOAD(curr + prefs - 1)),
+			absDiff_AVX512(c, e)),
+			absDiff_AVX512(AVX512_LOAD(curr + mrefs + 1), AVX512_LOAD(curr + prefs + 1))),
+			pw1
+		);
+
+		check_AVX512(curr, prefs, mrefs, -2, spatialScore, spatialPred, check_AVX512(curr, prefs, mrefs, -1, spatialScore, spatialPred, allLanes));
+		check_AVX512(curr, prefs, mrefs, +2, spatialScore, spatialPred, check_AVX512(curr, prefs, mrefs, +1, spatialScore, spatialPred, allLanes));
+
+		if (spatialCheck)
+		{
+			const __m512i b = _mm512_srli_epi16(_mm512_add_epi16(AVX512_LOAD(prev2 + 2 * mrefs), AVX512_LOAD(next2 + 2 * mrefs)), 1);
+			const __m512i f = _mm512_srli_epi16(_mm512_add_epi16(AVX512_LOAD(prev2 + 2 * prefs), AVX512_LOAD(next2 + 2 * prefs)), 1);
+			const __m512i dMinusE = _mm512_sub_epi16(d, e);
+			const __m512i dMinusC = _mm512_sub_epi16(d, c);
+			const __m512i bMinusC = _mm512_sub_epi16(b, c);
+			const __m512i fMinusE = _mm512_sub_epi16(f, e);
+			const __m512i maxVal = _mm512_max_epi16(_mm512_max_epi16(dMinusE, dMinusC), _mm512_min_epi16(bMinusC, fMinusE));
+			const __m512i minVal = _mm512_min_epi16(_mm512_min_epi16(dMinusE, dMinusC), _mm512_max_epi16(bMinusC, fMinusE));
+			diff = _mm512_max_epi16(_mm512_max_epi16(diff, minVal), _mm512_sub_epi16(_mm512_setzero_si512(), maxVal));
+		}
+
+		spatialPred = _mm512_max_epi16(_mm512_min_epi16(spatialPred, _mm512_add_epi16(d, diff)), _mm512_sub_epi16(d, diff));
+
+		// Values are always in range 0..255 here, so truncation is enough
+		_mm256_storeu_si256((__m256i *)dest, _mm512_cvtepi16_epi8(spatialPred));
+
+		dest  += 32;
+		prev  += 32;
+		curr  += 32;
+		next  += 32;
+		prev2 += 32;
+		next2 += 32;
+	}
+}
+
+#undef AVX512_LOAD
+
+#endif // QMPLAY2_YADIF_AVX512
+
+#undef QMPLAY2_TARGET
+
 #endif // QMPLAY2_CPU_X86
 static void filterLine_CPP(quint8 *dest, const void *const destEnd,
                            const quint8 *prev, const quint8 *curr, const quint8 *next,
@@ -451,10 +648,11 @@ static void filterSlice(const int plane, const int parity, const int tff, const
 				doSpatialCheck,
 				filterParity
 			);
+			const int simdEnd = max(w - toSub, 3); //Line can be narrower than SIMD width
 			filterLinePtr
 			(
 				dest  + 3,
-				dest  + w - toSub,
+				dest  + simdEnd,
 				prev  + 3,
 				curr  + 3,
 				next  + 3,
@@ -465,11 +663,11 @@ static void filterSlice(const int plane, const int parity, const int tff, const
 			);
 			filterLine<true>
 			(
-				dest  + w - toSub,
+				dest  + simdEnd,
 				dest  + w - 3,
-				prev  + w - toSub,
-				curr  + w - toSub,
-				next  + w - toSub,
+				prev  + simdEnd,
+				curr  + simdEnd,
+				next  + simdEnd,
 				prefs,
 				mrefs,
 				doSpatialCheck,
@@ -495,59 +693,6 @@ static void filterSlice(const int plane, const int parity, const int tff, const
 	}
 }
 
-/* Yadif thread */
-
-YadifThr::YadifThr(const YadifDeint &yadifDeint) :
-	yadifDeint(yadifDeint),
-	hasNewData(false), br(false)
-{
-	setObjectName("YadifThr");
-	QThread::start();
-}
-YadifThr::~YadifThr()
-{
-	{
-		QMutexLocker locker(&mutex);
-		br = true;
-		cond.wakeOne();
-	}
-	wait();
-}
-
-void YadifThr::start(VideoFrame &destFrame, const VideoFrame &prevFrame, const VideoFrame &currFrame, const VideoFrame &nextFrame, const int id, const int n)
-{
-	QMutexLocker locker(&mutex);
-	dest = &destFrame;
-	prev = &prevFrame;
-	curr = &currFrame;
-	next = &nextFrame;
-	jobId = id;
-	jobsCount = n;
-	hasNewData = true;
-	cond.wakeOne();
-}
-void YadifThr::waitForFinished()
-{
-	QMutexLocker locker(&mutex);
-	while (hasNewData)
-		cond.wait(&mutex);
-}
-
-void YadifThr::run()
-{
-	while (!br)
-	{
-		QMutexLocker locker(&mutex);
-		if (!hasNewData && !br)
-			cond.wait(&mutex);
-		if (!hasNewData || br)
-			continue;
-		yadifDeint.doFilter(*dest, *prev, *curr, *next, jobId, jobsCount);
-		hasNewData = false;
-		cond.wakeOne();
-	}
-}
-
 /* Yadif deint filter */
 
 YadifDeint::YadifDeint(bool doubler, bool spatialCheck) :
@@ -560,7 +705,20 @@ YadifDeint::YadifDeint(bool doubler, bool spatialCheck) :
 		alignment = 1;
 #ifdef QMPLAY2_CPU_X86
 		const int cpuFlags = av_get_cpu_flags();
-		if (cpuFlags & AV_CPU_FLAG_SSE2)
+#ifdef QMPLAY2_YADIF_AVX512
+		if (cpuFlags & AV_CPU_FLAG_AVX512)
+		{
+			filterLinePtr = filterLine_AVX512;
+			alignment = 32;
+		}
+		else
+#endif // QMPLAY2_YADIF_AVX512
+		if (cpuFlags & AV_CPU_FLAG_AVX2)
+		{
+			filterLinePtr = filterLine_AVX2;
+			alignment = 16;
+		}
+		else if (cpuFlags & AV_CPU_FLAG_SSE2)
 		{
 			filterLinePtr = filterLine_SSE2;
 			alignment = 8;
@@ -595,22 +753,11 @@ bool YadifDeint::filter(QQueue<FrameBuffer> &framesQueue)
 
 		VideoFrame destFrame(currBuffer.frame.size, currBuffer.frame.linesize);
 
-		const int halfH = destFrame.size.chromaHeight();
-
-		if (threads.isEmpty())
-		{
-			threads.resize(min(QThread::idealThreadCount(), 18));
-			for (int i = 0; i < threads.count(); ++i)
-				threads[i] = YadifThrPtr(new YadifThr(*this));
-		}
-
-		const int threadsCount = min(threads.count(), halfH);
-		for (int i = 1; i < threadsCount; ++i)
-			threads[i]->start(destFrame, prevBuffer.frame, currBuffer.frame, nextBuffer.frame, i, threadsCount);
-		doFilter(destFrame, prevBuffer.frame, currBuffer.frame, nextBuffer.frame, 0, threadsCount);
-
-		for (int i = 0; i < threadsCount; ++i)
-			threads[i]->waitForFinished();
+		// Small slices are distributed dynamically between threads, so uneven cost of slices doesn't leave threads idle
+		const int jobsCount = max(1, min(WorkerPool::instance().threadsCount() * 8, destFrame.size.chromaHeight() / 4));
+		WorkerPool::instance().run(jobsCount, [&](int jobId) {
+			doFilter(destFrame, prevBuffer.frame, currBuffer.frame, nextBuffer.frame, jobId, jobsCount);
+		});
 
 		double ts = currBuffer.ts;
 		if (secondFrame)
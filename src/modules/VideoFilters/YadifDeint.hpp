@@ -20,40 +20,8 @@
 
 #include <DeintFilter.hpp>
 
-#include <QWaitCondition>
-#include <QVector>
-#include <QThread>
-#include <QMutex>
-
-#include <memory>
-
-class YadifDeint;
-
-class YadifThr final : public QThread
-{
-public:
-	YadifThr(const YadifDeint &yadifDeint);
-	~YadifThr();
-
-	void start(VideoFrame &destFrame, const VideoFrame &prevFrame, const VideoFrame &currFrame, const VideoFrame &nextFrame, const int id, const int n);
-	void waitForFinished();
-private:
-	void run() override;
-
-	const YadifDeint &yadifDeint;
-
-	VideoFrame *dest;
-	const VideoFrame *prev, *curr, *next;
-	int jobId, jobsCount;
-	bool hasNewData, br;
-
-	QWaitCondition cond;
-	QMutex mutex;
-};
-
 class YadifDeint final : public DeintFilter
 {
-	friend class YadifThr;
 public:
 	YadifDeint(bool doubler, bool spatialCheck);
 
@@ -65,9 +33,6 @@ public:
 private:
 	inline void doFilter(VideoFrame &dest, const VideoFrame &prev, const VideoFrame &curr, const VideoFrame &next, const int id, const int jobsCount) const;
 
-	using YadifThrPtr = std::shared_ptr<YadifThr>;
-	QVector<YadifThrPtr> threads;
-
 	const bool doubler, spatialCheck;
 	bool secondFrame;
 };
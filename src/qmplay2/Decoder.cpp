@@ -18,8 +18,8 @@
 
 #include <Decoder.hpp>
 
+#include <ModulesRegistry.hpp>
 #include <StreamInfo.hpp>
-#include <Module.hpp>
 
 class QMPlay2DummyDecoder : public Decoder
 {
@@ -42,27 +42,27 @@ Decoder *Decoder::create(StreamInfo &streamInfo, VideoWriter *writer, const QStr
 		decoder->open(streamInfo);
 		return decoder;
 	}
-	QVector<QPair<Module *, Module::Info>> pluginsInstances(modNames.count());
-	for (Module *pluginInstance : QMPlay2Core.getPluginsInstance())
-		for (const Module::Info &mod : pluginInstance->getModulesInfo())
-			if (mod.type == Module::DECODER)
+	const auto modulesRegistry = ModulesRegistry::get();
+	ModulesRegistry::ItemPtrs pluginsInstances(modNames.count());
+	for (const ModulesRegistry::Item &item : modulesRegistry->items(Module::DECODER))
+		if (item.info.type == Module::DECODER)
+		{
+			if (modNames.isEmpty())
+				pluginsInstances += &item;
+			else
 			{
-				if (modNames.isEmpty())
-					pluginsInstances += {pluginInstance, mod};
-				else
-				{
-					const int idx = modNames.indexOf(mod.name);
-					if (idx > -1)
-						pluginsInstances[idx] = {pluginInstance, mod};
-				}
+				const int idx = modNames.indexOf(item.info.name);
+				if (idx > -1)
+					pluginsInstances[idx] = &item;
 			}
+		}
 	for (int i = 0; i < pluginsInstances.count(); i++)
 	{
-		Module *module = pluginsInstances[i].first;
-		Module::Info &moduleInfo = pluginsInstances[i].second;
-		if (!module || moduleInfo.name.isEmpty())
+		const ModulesRegistry::Item *item = pluginsInstances.at(i);
+		if (!item || item->info.name.isEmpty())
 			continue;
-		Decoder *decoder = (Decoder *)module->createInstance(moduleInfo.name);
+		const Module::Info &moduleInfo = item->info;
+		Decoder *decoder = (Decoder *)item->module->createInstance(moduleInfo.name);
 		if (!decoder)
 			continue;
 		if (decoder->open(streamInfo, writer))
@@ -18,8 +18,8 @@
 
 #include <Demuxer.hpp>
 
+#include <ModulesRegistry.hpp>
 #include <Functions.hpp>
-#include <Module.hpp>
 
 bool Demuxer::create(const QString &url, IOController<Demuxer> &demuxer, FetchTracks *fetchTracks)
 {
@@ -27,43 +27,49 @@ bool Demuxer::create(const QString &url, IOController<Demuxer> &demuxer, FetchTr
 	if (demuxer.isAborted() || url.isEmpty() || scheme.isEmpty())
 		return false;
 	const QString extension = Functions::fileExt(url).toLower();
+	const auto modulesRegistry = ModulesRegistry::get();
 	for (int i = 0; i <= 1; ++i)
-		for (Module *module : QMPlay2Core.getPluginsInstance())
-			for (const Module::Info &mod : module->getModulesInfo())
-				if (mod.type == Module::DEMUXER && (mod.name == scheme || (!i ? mod.extensions.contains(extension) : mod.extensions.isEmpty())))
+	{
+		const ModulesRegistry::ItemPtrs items = !i
+			? modulesRegistry->find(Module::DEMUXER, scheme, extension)
+			: modulesRegistry->findWithoutExtensions(Module::DEMUXER, scheme);
+		for (const ModulesRegistry::Item *item : items)
+		{
+			if (item->info.type != Module::DEMUXER)
+				continue;
+			if (!demuxer.assign((Demuxer *)item->module->createInstance(item->info.name)))
+				continue;
+			bool canDoOpen = true;
+			if (fetchTracks)
+			{
+				fetchTracks->isOK = true;
+				fetchTracks->tracks = demuxer->fetchTracks(url, fetchTracks->isOK);
+				if (fetchTracks->isOK) //If tracks are fetched correctly (even if track list is empty)
 				{
-					if (!demuxer.assign((Demuxer *)module->createInstance(mod.name)))
-						continue;
-					bool canDoOpen = true;
-					if (fetchTracks)
+					if (!fetchTracks->tracks.isEmpty()) //Return tracks list
 					{
-						fetchTracks->isOK = true;
-						fetchTracks->tracks = demuxer->fetchTracks(url, fetchTracks->isOK);
-						if (fetchTracks->isOK) //If tracks are fetched correctly (even if track list is empty)
-						{
-							if (!fetchTracks->tracks.isEmpty()) //Return tracks list
-							{
-								demuxer.reset();
-								return true;
-							}
-							if (fetchTracks->onlyTracks) //If there are no tracks and we want only track list - return false
-							{
-								demuxer.reset();
-								return false;
-							}
-						}
-						else //Tracks can't be fetched - an error occured
-						{
-							fetchTracks->tracks.clear(); //Clear if list is not empty
-							canDoOpen = false;
-						}
-					}
-					if (canDoOpen && demuxer->open(url))
+						demuxer.reset();
 						return true;
-					demuxer.reset();
-					if (mod.name == scheme || demuxer.isAborted())
+					}
+					if (fetchTracks->onlyTracks) //If there are no tracks and we want only track list - return false
+					{
+						demuxer.reset();
 						return false;
+					}
+				}
+				else //Tracks can't be fetched - an error occured
+				{
+					fetchTracks->tracks.clear(); //Clear if list is not empty
+					canDoOpen = false;
 				}
+			}
+			if (canDoOpen && demuxer->open(url))
+				return true;
+			demuxer.reset();
+			if (item->info.name == scheme || demuxer.isAborted())
+				return false;
+		}
+	}
 	return false;
 }
 
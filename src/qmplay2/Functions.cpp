@@ -19,6 +19,7 @@
 #include <Functions.hpp>
 
 #include <QMPlay2Extensions.hpp>
+#include <ModulesRegistry.hpp>
 #include <DeintFilter.hpp>
 #include <QMPlay2OSD.hpp>
 #include <VideoFrame.hpp>
@@ -671,13 +672,13 @@ void Functions::getDataIfHasPluginPrefix(const QString &entireUrl, QString *url,
 		const QString extension = fileExt(entireUrl).toLower();
 		if (demuxersInfo.isEmpty())
 		{
-			for (const Module *module : QMPlay2Core.getPluginsInstance())
-				for (const Module::Info &mod : module->getModulesInfo())
-					if (mod.type == Module::DEMUXER && (mod.name == scheme || mod.extensions.contains(extension)))
-					{
-						*icon = !mod.icon.isNull() ? mod.icon : module->icon();
-						return;
-					}
+			const auto modulesRegistry = ModulesRegistry::get();
+			for (const ModulesRegistry::Item *item : modulesRegistry->find(Module::DEMUXER, scheme, extension))
+				if (item->info.type == Module::DEMUXER)
+				{
+					*icon = !item->info.icon.isNull() ? item->info.icon : item->module->icon();
+					return;
+				}
 		}
 		else
 		{
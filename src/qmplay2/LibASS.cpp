@@ -131,6 +131,7 @@ LibASS::~LibASS()
 
 void LibASS::setWindowSize(int _winW, int _winH)
 {
+	++m_revision;
 	const qreal dpr = QMPlay2Core.getVideoDevicePixelRatio();
 	winW = _winW * dpr;
 	winH = _winH * dpr;
@@ -138,25 +139,30 @@ void LibASS::setWindowSize(int _winW, int _winH)
 }
 void LibASS::setARatio(double _aspect_ratio)
 {
+	++m_revision;
 	aspect_ratio = _aspect_ratio;
 	calcSize();
 }
 void LibASS::setZoom(double _zoom)
 {
+	++m_revision;
 	zoom = _zoom;
 	calcSize();
 }
 void LibASS::setFontScale(double fs)
 {
+	++m_revision;
 	fontScale = fs;
 }
 
 void LibASS::addFont(const QByteArray &name, const QByteArray &data)
 {
+	++m_revision;
 	ass_add_font(ass, (char *)name.constData(), (char *)data.constData(), data.size());
 }
 void LibASS::clearFonts()
 {
+	++m_revision;
 	ass_clear_fonts(ass);
 	ass_set_fonts_dir(ass, nullptr);
 }
@@ -237,6 +243,7 @@ void LibASS::closeOSD()
 
 void LibASS::initASS(const QByteArray &ass_data)
 {
+	++m_revision;
 	if (ass_sub_track && ass_sub_renderer)
 		return;
 
@@ -265,6 +272,7 @@ bool LibASS::isASS() const
 }
 void LibASS::setASSStyle()
 {
+	++m_revision;
 	if (!ass_sub_track)
 		return;
 
@@ -375,7 +383,9 @@ void LibASS::addASSEvent(const QByteArray &event)
 {
 	if (!ass_sub_track || !ass_sub_renderer || event.isEmpty())
 		return;
+	const int eventsCount = ass_sub_track->n_events;
 	ass_process_data(ass_sub_track, (char *)event.constData(), event.size());
+	eventsAdded(eventsCount);
 }
 void LibASS::addASSEvent(const QByteArray &text, double Start, double Duration)
 {
@@ -388,13 +398,30 @@ void LibASS::addASSEvent(const QByteArray &text, double Start, double Duration)
 	event->Duration = Duration * 1000;
 	event->Style = 0;
 	event->ReadOrder = eventID;
+	eventsAdded(eventID);
 }
 void LibASS::flushASSEvents()
 {
+	++m_revision;
 	if (!ass_sub_track || !ass_sub_renderer)
 		return;
 	ass_flush_events(ass_sub_track);
 }
+void LibASS::eventsAdded(int firstEvent)
+{
+	//Only events visible in already rendered time range can change the rendered subtitles
+	if (m_renderedRevision != m_revision || m_renderedFrom > m_renderedTo)
+		return;
+	for (int i = firstEvent; i < ass_sub_track->n_events; ++i)
+	{
+		const ASS_Event &event = ass_sub_track->events[i];
+		if (event.Start <= m_renderedTo && event.Start + event.Duration > m_renderedFrom)
+		{
+			++m_revision;
+			return;
+		}
+	}
+}
 bool LibASS::getASS(QMPlay2OSD *&osd, double pos)
 {
 	if (!ass_sub_track || !ass_sub_renderer || !W || !H)
@@ -428,8 +455,20 @@ bool LibASS::getASS(QMPlay2OSD *&osd, double pos)
 	const int marginTB = qMax(0, H / 2 - winH / 2);
 	ass_set_margins(ass_sub_renderer, marginTB, marginTB, marginLR, marginLR);
 
+	const qint64 posMs = pos * 1000;
+	if (m_renderedRevision != m_revision || m_renderedFrom > m_renderedTo)
+	{
+		m_renderedRevision = m_revision;
+		m_renderedFrom = m_renderedTo = posMs;
+	}
+	else
+	{
+		m_renderedFrom = qMin(m_renderedFrom, posMs);
+		m_renderedTo = qMax(m_renderedTo, posMs);
+	}
+
 	int ch;
-	ASS_Image *img = ass_render_frame(ass_sub_renderer, ass_sub_track, pos * 1000, &ch);
+	ASS_Image *img = ass_render_frame(ass_sub_renderer, ass_sub_track, posMs, &ch);
 
 	if (_fontScale != 1.0)
 	{
@@ -469,6 +508,7 @@ bool LibASS::getASS(QMPlay2OSD *&osd, double pos)
 }
 void LibASS::closeASS()
 {
+	++m_revision;
 	while (ass_sub_styles_copy.size())
 	{
 		ASS_Style *style = ass_sub_styles_copy.takeFirst();
@@ -0,0 +1,134 @@
+/*
+	QMPlay2 is a video and audio player.
+	Copyright (C) 2010-2018  Błażej Szczygieł
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU Lesser General Public License as published
+	by the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <ModulesRegistry.hpp>
+
+#include <QMPlay2Core.hpp>
+
+#include <QAtomicInt>
+#include <QMutex>
+
+static QAtomicInt g_version;
+static QMutex g_mutex;
+static std::shared_ptr<const ModulesRegistry> g_registry;
+
+std::shared_ptr<const ModulesRegistry> ModulesRegistry::get()
+{
+	QMutexLocker locker(&g_mutex);
+	const int version = g_version.load();
+	if (!g_registry || g_registry->m_version != version)
+		g_registry.reset(new ModulesRegistry(version)); //Settings changed while building are caught by the next call
+	return g_registry;
+}
+void ModulesRegistry::invalidate()
+{
+	g_version.ref();
+}
+void ModulesRegistry::reset()
+{
+	invalidate();
+	QMutexLocker locker(&g_mutex);
+	g_registry.reset();
+}
+
+const ModulesRegistry::Items &ModulesRegistry::items(quint32 type) const
+{
+	static const Items empty;
+	return (type < (quint32)m_types.count()) ? m_types.at(type).items : empty;
+}
+
+const ModulesRegistry::Item *ModulesRegistry::find(quint32 type, const QString &name) const
+{
+	if (type >= (quint32)m_types.count())
+		return nullptr;
+	const TypeIndex &typeIndex = m_types.at(type);
+	const int idx = typeIndex.byName.value(name, -1);
+	return (idx > -1) ? &typeIndex.items.at(idx) : nullptr;
+}
+ModulesRegistry::ItemPtrs ModulesRegistry::find(quint32 type, const QString &name, const QString &extension) const
+{
+	if (type >= (quint32)m_types.count())
+		return ItemPtrs();
+	const TypeIndex &typeIndex = m_types.at(type);
+	return merge(typeIndex, typeIndex.byName.value(name, -1), typeIndex.byExtension.value(extension));
+}
+ModulesRegistry::ItemPtrs ModulesRegistry::findWithoutExtensions(quint32 type, const QString &name) const
+{
+	if (type >= (quint32)m_types.count())
+		return ItemPtrs();
+	const TypeIndex &typeIndex = m_types.at(type);
+	return merge(typeIndex, typeIndex.byName.value(name, -1), typeIndex.withoutExtensions);
+}
+
+QStringList ModulesRegistry::extensions(quint32 type) const
+{
+	QStringList extensions;
+	for (const Item &item : items(type))
+		extensions += item.info.extensions;
+	return extensions;
+}
+
+ModulesRegistry::ModulesRegistry(int version) :
+	m_version(version),
+	m_types(Module::VIDEOFILTER + 1)
+{
+	for (Module *module : QMPlay2Core.getPluginsInstance())
+	{
+		for (const Module::Info &info : module->getModulesInfo())
+		{
+			const quint32 type = info.type & 0xF;
+			if (type >= (quint32)m_types.count())
+				continue;
+
+			TypeIndex &typeIndex = m_types[type];
+			const int idx = typeIndex.items.count();
+			typeIndex.items += {module, info};
+
+			if (!typeIndex.byName.contains(info.name))
+				typeIndex.byName[info.name] = idx;
+
+			if (info.extensions.isEmpty())
+				typeIndex.withoutExtensions += idx;
+			else for (const QString &extension : info.extensions)
+			{
+				QVector<int> &idxs = typeIndex.byExtension[extension];
+				if (idxs.isEmpty() || idxs.last() != idx)
+					idxs += idx;
+			}
+		}
+	}
+}
+
+ModulesRegistry::ItemPtrs ModulesRegistry::merge(const TypeIndex &typeIndex, int nameIdx, const QVector<int> &idxs)
+{
+	ItemPtrs items;
+	items.reserve(idxs.count() + 1);
+	for (const int idx : idxs)
+	{
+		if (nameIdx > -1 && nameIdx <= idx)
+		{
+			if (nameIdx < idx)
+				items += &typeIndex.items.at(nameIdx);
+			nameIdx = -1;
+		}
+		items += &typeIndex.items.at(idx);
+	}
+	if (nameIdx > -1)
+		items += &typeIndex.items.at(nameIdx);
+	return items;
+}
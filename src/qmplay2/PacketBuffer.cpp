@@ -18,92 +18,118 @@
 
 #include <PacketBuffer.hpp>
 
+#include <QThread>
+
 #include <cmath>
 
+template<typename Pred>
+static quint64 lowerBound(quint64 first, quint64 last, Pred pred)
+{
+	// Returns first index in [first, last) for which "pred" is false, "pred" must be monotonic
+	quint64 count = last - first;
+	while (count > 0)
+	{
+		const quint64 step = count / 2;
+		const quint64 mid = first + step;
+		if (pred(mid))
+		{
+			first = mid + 1;
+			count -= step + 1;
+		}
+		else
+		{
+			count = step;
+		}
+	}
+	return first;
+}
+
+constexpr int g_initialCapacity = 1024; //Must be power of 2
+constexpr quint64 g_notReading = ~0ull;
+
 int PacketBuffer::backwardPackets;
 
+PacketBuffer::PacketBuffer() :
+	m_ring(new Ring(g_initialCapacity)),
+	m_pos(0),
+	m_end(0),
+	m_reading(g_notReading),
+	m_keyFrames(g_initialCapacity)
+{}
+PacketBuffer::~PacketBuffer()
+{
+	delete m_ring.load();
+	qDeleteAll(m_retired);
+}
+
 bool PacketBuffer::seekTo(double seekPos, bool backward)
 {
-	const int count = packetsCount();
-	if (count == 0)
+	const Ring *r = ring();
+	const quint64 end = m_end.load();
+	if (end == m_first)
 		return false;
 
-	const bool findBackwards = (m_pos > 0 && seekPos < at(m_pos - 1).ts);
+	const auto ts = [r](const quint64 idx)->double {
+		return r->at(idx).packet.ts;
+	};
 
-	if (findBackwards && at(0).ts > seekPos)
+	quint64 pos = m_pos.load();
+	for (;;)
 	{
-		if (floor(at(0).ts) > seekPos)
-			return false; // No packets for backward seek
-		seekPos = at(0).ts;
-	}
-	else if (!findBackwards && at(count - 1).ts < seekPos)
-	{
-		if (ceil(at(count - 1).ts) < seekPos)
-			return false; // No packets for forward seek
-		seekPos = at(count - 1).ts;
-	}
+		double seekTs = seekPos;
 
-	double durationToChange = 0.0;
-	qint64 sizeToChange = 0;
-	int tmpPos;
+		const bool findBackwards = (pos > m_first && seekTs < ts(pos - 1));
 
-	const auto doSeek = [&](const int currPos, const bool forward, const bool keyFrame) {
-		tmpPos = -1;
-		if (forward)
+		if (findBackwards && ts(m_first) > seekTs)
 		{
-			for (int i = currPos; i < count; ++i)
-			{
-				const Packet &pkt = at(i);
-				if (pkt.ts >= seekPos && (!keyFrame || pkt.hasKeyFrame))
-				{
-					tmpPos = i;
-					return true;
-				}
-				else
-				{
-					durationToChange += pkt.duration;
-					sizeToChange += pkt.size();
-				}
-			}
+			if (floor(ts(m_first)) > seekTs)
+				return false; // No packets for backward seek
+			seekTs = ts(m_first);
 		}
-		else for (int i = currPos - 1; i >= 0; --i)
+		else if (!findBackwards && ts(end - 1) < seekTs)
 		{
-			const Packet &pkt = at(i);
-			durationToChange -= pkt.duration;
-			sizeToChange -= pkt.size();
-			if (pkt.ts <= seekPos && (!keyFrame || pkt.hasKeyFrame))
-			{
-				tmpPos = i;
-				return true;
-			}
+			if (ceil(ts(end - 1)) < seekTs)
+				return false; // No packets for forward seek
+			seekTs = ts(end - 1);
 		}
-		return false;
-	};
 
-	if (doSeek(m_pos, !findBackwards, false))
-	{
-		if (at(tmpPos).hasKeyFrame || doSeek(tmpPos, !backward, true))
+		quint64 tmpPos;
+
+		if (!findBackwards)
 		{
-			m_remainingDuration -= durationToChange;
-			m_backwardDuration += durationToChange;
-			m_remainingBytes -= sizeToChange;
-			m_backwardBytes += sizeToChange;
+			// First packet with timestamp not less than "seekTs"
+			tmpPos = lowerBound(pos, end, [&](quint64 idx) {
+				return r->at(idx).maxTs < seekTs;
+			});
+			if (tmpPos == end)
+				return false;
+		}
+		else
+		{
+			// Last packet with timestamp not greater than "seekTs"
+			tmpPos = lowerBound(m_first, pos, [&](quint64 idx) {
+				return r->at(idx).maxTs <= seekTs;
+			});
+			if (tmpPos-- == m_first)
+				return false;
+		}
 
-			m_pos = tmpPos;
+		if (!r->at(tmpPos).packet.hasKeyFrame && !findKeyFrame(tmpPos, seekTs, !backward))
+			return false;
 
+		// Consumer might have fetched a packet in the meantime, try again from the new position
+		if (m_pos.compare_exchange_strong(pos, tmpPos))
 			return true;
-		}
 	}
-
-	return false;
 }
 void PacketBuffer::clear()
 {
 	lock();
-	QList<Packet>::clear();
-	m_remainingDuration = m_backwardDuration = 0.0;
-	m_remainingBytes = m_backwardBytes = 0;
-	m_pos = 0;
+	const quint64 end = m_end.load();
+	m_pos.store(end);
+	waitForConsumer(end);
+	dropUntil(end);
+	m_maxTs = -qInf();
 	unlock();
 }
 
@@ -111,29 +137,166 @@ void PacketBuffer::put(const Packet &packet)
 {
 	lock();
 	clearBackwards();
-	append(packet);
-	m_remainingBytes += packet.size();
-	m_remainingDuration += packet.duration;
+	const quint64 end = m_end.load();
+	if (end - m_first > ring()->mask)
+		grow();
+	m_maxTs = qMax<double>(m_maxTs, packet.ts);
+	Slot &slot = ring()->at(end);
+	slot.packet = packet;
+	slot.durationBefore = m_durationSum;
+	slot.bytesBefore = m_bytesSum;
+	slot.maxTs = m_maxTs;
+	if (packet.hasKeyFrame)
+		addKeyFrame(end);
+	m_durationSum += packet.duration;
+	m_bytesSum += packet.size();
+	m_end.store(end + 1);
+	releaseRetired();
 	unlock();
 }
-Packet PacketBuffer::fetch()
+bool PacketBuffer::fetch(Packet &packet)
 {
-	const Packet &packet = at(m_pos++);
-	m_remainingDuration -= packet.duration;
-	m_backwardDuration += packet.duration;
-	m_remainingBytes -= packet.size();
-	m_backwardBytes += packet.size();
-	return packet;
+	for (;;)
+	{
+		const quint64 pos = m_pos.load();
+		if (pos >= m_end.load())
+			return false;
+
+		// Announce which slot is being read, so producer won't release it or its ring
+		m_reading.store(pos);
+		if (m_pos.load() != pos)
+		{
+			m_reading.store(g_notReading);
+			continue;
+		}
+
+		const Ring *r = ring();
+		Packet tmpPacket = r->at(pos).packet;
+
+		quint64 expected = pos;
+		const bool ok = m_pos.compare_exchange_strong(expected, pos + 1);
+		m_reading.store(g_notReading);
+		if (ok)
+		{
+			packet = std::move(tmpPacket);
+			return true;
+		}
+	}
 }
 
 void PacketBuffer::clearBackwards()
 {
-	while (m_pos > backwardPackets)
+	const quint64 pos = safePos();
+	if (pos > m_first + backwardPackets)
+		dropUntil(pos - backwardPackets);
+}
+
+double PacketBuffer::remainingDuration() const
+{
+	return m_durationSum - durationBefore(m_pos.load());
+}
+double PacketBuffer::backwardDuration() const
+{
+	return durationBefore(m_pos.load()) - durationBefore(m_first);
+}
+
+qint64 PacketBuffer::remainingBytes() const
+{
+	return m_bytesSum - bytesBefore(m_pos.load());
+}
+qint64 PacketBuffer::backwardBytes() const
+{
+	return bytesBefore(m_pos.load()) - bytesBefore(m_first);
+}
+
+inline double PacketBuffer::durationBefore(quint64 idx) const
+{
+	return (idx >= m_end.load()) ? m_durationSum : ring()->at(idx).durationBefore;
+}
+inline qint64 PacketBuffer::bytesBefore(quint64 idx) const
+{
+	return (idx >= m_end.load()) ? m_bytesSum : ring()->at(idx).bytesBefore;
+}
+
+quint64 PacketBuffer::safePos() const
+{
+	// Position must be loaded before the consumer slot
+	const quint64 pos = m_pos.load();
+	return qMin(pos, m_reading.load());
+}
+void PacketBuffer::waitForConsumer(quint64 idx) const
+{
+	while (m_reading.load() < idx)
+		QThread::yieldCurrentThread();
+}
+void PacketBuffer::dropUntil(quint64 idx)
+{
+	Ring *r = ring();
+	for (; m_first < idx; ++m_first)
+		r->at(m_first).packet = Packet();
+	while (m_keyFramesFirst < m_keyFramesEnd && keyFrameAt(m_keyFramesFirst) < m_first)
+		++m_keyFramesFirst;
+}
+
+void PacketBuffer::addKeyFrame(quint64 idx)
+{
+	const int capacity = m_keyFrames.count();
+	if (m_keyFramesEnd - m_keyFramesFirst == quint64(capacity))
+	{
+		QVector<quint64> keyFrames(capacity * 2);
+		for (quint64 i = m_keyFramesFirst; i < m_keyFramesEnd; ++i)
+			keyFrames[i & (keyFrames.count() - 1)] = keyFrameAt(i);
+		m_keyFrames = std::move(keyFrames);
+	}
+	m_keyFrames[m_keyFramesEnd++ & (m_keyFrames.count() - 1)] = idx;
+}
+bool PacketBuffer::findKeyFrame(quint64 &idx, double seekTs, bool forward) const
+{
+	const Ring *r = ring();
+
+	// First key frame at or after "idx"
+	quint64 k = lowerBound(m_keyFramesFirst, m_keyFramesEnd, [&](quint64 kIdx) {
+		return keyFrameAt(kIdx) < idx;
+	});
+
+	if (forward)
+	{
+		for (; k < m_keyFramesEnd; ++k)
+		{
+			if (r->at(keyFrameAt(k)).packet.ts >= seekTs)
+			{
+				idx = keyFrameAt(k);
+				return true;
+			}
+		}
+	}
+	else while (k-- > m_keyFramesFirst)
+	{
+		if (r->at(keyFrameAt(k)).packet.ts <= seekTs)
+		{
+			idx = keyFrameAt(k);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void PacketBuffer::grow()
+{
+	Ring *oldRing = ring();
+	Ring *newRing = new Ring(oldRing->slots.count() * 2);
+	for (quint64 i = m_first, end = m_end.load(); i < end; ++i)
+		newRing->at(i) = oldRing->at(i);
+	m_ring.store(newRing);
+	// Consumer can still copy a packet from the old ring, it is deleted when it's not used anymore
+	m_retired.append(oldRing);
+}
+void PacketBuffer::releaseRetired()
+{
+	if (!m_retired.isEmpty() && m_reading.load() == g_notReading)
 	{
-		const Packet &tmpPacket = first();
-		m_backwardDuration -= tmpPacket.duration;
-		m_backwardBytes -= tmpPacket.size();
-		removeFirst();
-		--m_pos;
+		qDeleteAll(m_retired);
+		m_retired.clear();
 	}
 }
@@ -18,8 +18,8 @@
 
 #include <Playlist.hpp>
 
+#include <ModulesRegistry.hpp>
 #include <Functions.hpp>
-#include <Module.hpp>
 #include <Writer.hpp>
 #include <Reader.hpp>
 
@@ -48,10 +48,10 @@ bool Playlist::write(const Entries &list, const QString &url, QString *name)
 QStringList Playlist::extensions()
 {
 	QStringList extensions;
-	for (const Module *module : QMPlay2Core.getPluginsInstance())
-		for (const Module::Info &mod : module->getModulesInfo())
-			if (mod.type == Module::PLAYLIST)
-				extensions += mod.extensions;
+	const auto modulesRegistry = ModulesRegistry::get();
+	for (const ModulesRegistry::Item &item : modulesRegistry->items(Module::PLAYLIST))
+		if (item.info.type == Module::PLAYLIST)
+			extensions += item.info.extensions;
 	return extensions;
 }
 
@@ -60,42 +60,43 @@ Playlist *Playlist::create(const QString &url, OpenMode openMode, QString *name)
 	const QString extension = Functions::fileExt(url).toLower();
 	if (extension.isEmpty())
 		return nullptr;
-	for (Module *module : QMPlay2Core.getPluginsInstance())
-		for (const Module::Info &mod : module->getModulesInfo())
-			if (mod.type == Module::PLAYLIST && mod.extensions.contains(extension))
+	const auto modulesRegistry = ModulesRegistry::get();
+	for (const ModulesRegistry::Item *item : modulesRegistry->find(Module::PLAYLIST, QString(), extension))
+		if (item->info.type == Module::PLAYLIST)
+		{
+			const Module::Info &mod = item->info;
+			if (openMode == NoOpen)
 			{
-				if (openMode == NoOpen)
-				{
-					if (name)
-						*name = mod.name;
-					return nullptr;
-				}
-				Playlist *playlist = (Playlist *)module->createInstance(mod.name);
-				if (!playlist)
-					continue;
-				switch (openMode)
-				{
-					case ReadOnly:
-					{
-						IOController<Reader> &reader = playlist->ioCtrl.toRef<Reader>();
-						Reader::create(url, reader); //TODO przerywanie (po co?)
-						if (reader && reader->size() <= 0)
-							reader.reset();
-					} break;
-					case WriteOnly:
-						playlist->ioCtrl.assign(Writer::create(url));
-						break;
-					default:
-						break;
-				}
-				if (playlist->ioCtrl)
+				if (name)
+					*name = mod.name;
+				return nullptr;
+			}
+			Playlist *playlist = (Playlist *)item->module->createInstance(mod.name);
+			if (!playlist)
+				continue;
+			switch (openMode)
+			{
+				case ReadOnly:
 				{
-					if (name)
-						*name = mod.name;
-					return playlist;
-				}
-				delete playlist;
+					IOController<Reader> &reader = playlist->ioCtrl.toRef<Reader>();
+					Reader::create(url, reader); //TODO przerywanie (po co?)
+					if (reader && reader->size() <= 0)
+						reader.reset();
+				} break;
+				case WriteOnly:
+					playlist->ioCtrl.assign(Writer::create(url));
+					break;
+				default:
+					break;
+			}
+			if (playlist->ioCtrl)
+			{
+				if (name)
+					*name = mod.name;
+				return playlist;
 			}
+			delete playlist;
+		}
 	return nullptr;
 }
 
@@ -18,7 +18,9 @@
 
 #include <QMPlay2Core.hpp>
 
+#include <ModulesRegistry.hpp>
 #include <VideoFilters.hpp>
+#include <WorkerPool.hpp>
 #include <Functions.hpp>
 #include <CppUtils.hpp>
 #include <Playlist.hpp>
@@ -29,8 +31,10 @@
 #include <QApplication>
 #include <QLibraryInfo>
 #include <QTranslator>
+#include <QDataStream>
 #include <QDateTime>
 #include <QLibrary>
+#include <QSaveFile>
 #include <QPointer>
 #include <QLocale>
 #include <QWindow>
@@ -95,6 +99,56 @@ static QByteArray getDataFromHash(const QString &url, Data &data)
 
 /**/
 
+struct SkippedLibrary
+{
+	qint64 size, mTime;
+	QString error; //Logged again instead of loading the library
+};
+using SkippedLibraries = QHash<QString, SkippedLibrary>;
+
+static QByteArray getSkippedLibrariesVersion()
+{
+	return Version::get() + " " + QByteArray::number(QMPLAY2_MODULES_API_VERSION) + " " + QT_VERSION_STR;
+}
+
+static SkippedLibraries loadSkippedLibraries(const QString &filePath)
+{
+	SkippedLibraries skippedLibs;
+	QFile file(filePath);
+	if (file.open(QFile::ReadOnly))
+	{
+		QDataStream stream(&file);
+		QByteArray version;
+		stream >> version;
+		if (version == getSkippedLibrariesVersion())
+		{
+			while (!stream.atEnd() && stream.status() == QDataStream::Ok)
+			{
+				QString libPath;
+				SkippedLibrary skippedLib;
+				stream >> libPath >> skippedLib.size >> skippedLib.mTime >> skippedLib.error;
+				if (stream.status() == QDataStream::Ok)
+					skippedLibs.insert(libPath, skippedLib);
+			}
+		}
+	}
+	return skippedLibs;
+}
+static void saveSkippedLibraries(const QString &filePath, const SkippedLibraries &skippedLibs)
+{
+	QSaveFile file(filePath);
+	if (file.open(QFile::WriteOnly))
+	{
+		QDataStream stream(&file);
+		stream << getSkippedLibrariesVersion();
+		for (auto it = skippedLibs.constBegin(), itEnd = skippedLibs.constEnd(); it != itEnd; ++it)
+			stream << it.key() << it->size << it->mTime << it->error;
+		file.commit();
+	}
+}
+
+/**/
+
 QMPlay2CoreClass *QMPlay2CoreClass::qmplay2Core;
 
 QMPlay2CoreClass::QMPlay2CoreClass() :
@@ -279,18 +333,51 @@ void QMPlay2CoreClass::init(bool loadModules, bool modulesInSubdirs, const QStri
 						pluginsList += fInfo;
 		}
 
+		//Libraries which can't be used as modules are remembered, so they are not loaded on every start
+		const QString skippedLibsPath = settingsDir + "SkippedLibraries.bin";
+		const SkippedLibraries oldSkippedLibs = loadSkippedLibraries(skippedLibsPath);
+		SkippedLibraries skippedLibs;
+		bool skippedLibsChanged = false;
+
+		const auto skipLibrary = [&](const QString &libPath, const SkippedLibrary &skippedLib) {
+			auto it = oldSkippedLibs.constFind(libPath);
+			if (it == oldSkippedLibs.constEnd() || it->size != skippedLib.size || it->mTime != skippedLib.mTime)
+				skippedLibsChanged = true;
+			skippedLibs.insert(libPath, skippedLib);
+		};
+
 		QStringList pluginsName;
 		for (const QFileInfo &fInfo : asConst(pluginsList))
 		{
 			if (QLibrary::isLibrary(fInfo.filePath()))
 			{
+				SkippedLibrary skippedLib {fInfo.size(), fInfo.lastModified().toMSecsSinceEpoch(), QString()};
+
+				auto it = oldSkippedLibs.constFind(fInfo.filePath());
+				if (it != oldSkippedLibs.constEnd() && it->size == skippedLib.size && it->mTime == skippedLib.mTime)
+				{
+					if (!it->error.isEmpty())
+						log(it->error, AddTimeToLog | ErrorLog | SaveLog);
+					skipLibrary(fInfo.filePath(), it.value());
+					continue;
+				}
+
+				const auto setError = [&](const QString &error, bool remember) {
+					log(error, AddTimeToLog | ErrorLog | SaveLog);
+					if (remember)
+					{
+						skippedLib.error = error;
+						skipLibrary(fInfo.filePath(), skippedLib);
+					}
+				};
+
 				QLibrary lib(fInfo.filePath());
 				// Don't override global symbols if they are different in libraries (e.g. Qt5 vs Qt4)
 #ifndef ADDRESS_SANITIZER
 				lib.setLoadHints(QLibrary::DeepBindHint);
 #endif
 				if (!lib.load())
-					log(lib.errorString(), AddTimeToLog | ErrorLog | SaveLog);
+					setError(lib.errorString(), false); //Missing dependencies can be installed later
 				else
 				{
 					using CreateQMPlay2ModuleInstance = Module  *(*)();
@@ -303,14 +390,14 @@ void QMPlay2CoreClass::init(bool loadModules, bool modulesInSubdirs, const QStri
 						const quint8 moduleApiVersion = (v & 0xFF);
 						if (moduleApiVersion != QMPLAY2_MODULES_API_VERSION)
 						{
-							log(fInfo.fileName() + " - " + tr("mismatch module API version"), AddTimeToLog | ErrorLog | SaveLog);
+							setError(fInfo.fileName() + " - " + tr("mismatch module API version"), true);
 							return false;
 						}
 						const quint8   qtMajorVersion = ((v >> 24) & 0xFF);
 						const quint8   qtMinorVersion = ((v >> 16) & 0xFF);
 						if (qtMajorVersion != QT_VERSION_MAJOR || qtMinorVersion < QT_VERSION_MINOR)
 						{
-							log(fInfo.fileName() + " - " + tr("mismatch module Qt version"), AddTimeToLog | ErrorLog | SaveLog);
+							setError(fInfo.fileName() + " - " + tr("mismatch module Qt version"), true);
 							return false;
 						}
 						return true;
@@ -320,9 +407,11 @@ void QMPlay2CoreClass::init(bool loadModules, bool modulesInSubdirs, const QStri
 					{
 #ifndef Q_OS_ANDROID
 						if (lib.resolve("qmplay2PluginInstance"))
-							log(fInfo.fileName() + " - " + tr("too old QMPlay2 library"), AddTimeToLog | ErrorLog | SaveLog);
+							setError(fInfo.fileName() + " - " + tr("too old QMPlay2 library"), true);
 						else
-							log(fInfo.fileName() + " - " + tr("invalid QMPlay2 library"), AddTimeToLog | ErrorLog | SaveLog);
+							setError(fInfo.fileName() + " - " + tr("invalid QMPlay2 library"), true);
+#else
+						skipLibrary(fInfo.filePath(), skippedLib); //Other libraries of the application
 #endif
 					}
 					else if (checkModuleAPIVersion(getQMPlay2ModuleAPIVersion()))
@@ -345,8 +434,13 @@ void QMPlay2CoreClass::init(bool loadModules, bool modulesInSubdirs, const QStri
 				}
 			}
 		}
+
+		if (skippedLibsChanged || skippedLibs.count() != oldSkippedLibs.count())
+			saveSkippedLibraries(skippedLibsPath, skippedLibs);
 	}
 
+	ModulesRegistry::reset();
+
 	VideoFilters::init();
 
 	connect(this, SIGNAL(restoreCursor()), this, SLOT(restoreCursorSlot()));
@@ -357,9 +451,11 @@ void QMPlay2CoreClass::quit()
 {
 	if (settingsDir.isEmpty())
 		return;
+	ModulesRegistry::reset();
 	for (Module *pluginInstance : asConst(pluginsInstance))
 		delete pluginInstance;
 	pluginsInstance.clear();
+	WorkerPool::instance().stop();
 	videoFilters.clear();
 	settingsDir.clear();
 	shareDir.clear();
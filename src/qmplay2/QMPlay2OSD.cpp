@@ -26,6 +26,21 @@ void QMPlay2OSD::genId()
 	m_id = ++g_id;
 }
 
+void QMPlay2OSD::copyImages(const QMPlay2OSD &other)
+{
+	other.lock();
+	const QList<Image> images = other.m_images;
+	const bool needsRescale = other.m_needsRescale;
+	const quint64 id = other.m_id;
+	other.unlock();
+
+	lock();
+	m_images = images;
+	m_needsRescale = needsRescale;
+	m_id = id;
+	unlock();
+}
+
 void QMPlay2OSD::clear(bool all)
 {
 	m_images.clear();
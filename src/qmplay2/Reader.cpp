@@ -18,6 +18,7 @@
 
 #include <Reader.hpp>
 
+#include <ModulesRegistry.hpp>
 #include <Functions.hpp>
 
 #include <QBuffer>
@@ -127,19 +128,20 @@ bool Reader::create(const QString &url, IOController<Reader> &reader, const QStr
 			reader.reset();
 		}
 	}
-	for (Module *module : QMPlay2Core.getPluginsInstance())
-		for (const Module::Info &mod : module->getModulesInfo())
-			if (mod.type == Module::READER && mod.extensions.contains(scheme) && (plugName.isEmpty() || mod.name == plugName))
-			{
-				if (reader.assign((Reader *)module->createInstance(mod.name)))
-				{
-					reader->_url = url;
-					if (reader->open())
-						return true;
-					reader.reset();
-				}
-				if (reader.isAborted())
-					break;
-			}
+	const auto modulesRegistry = ModulesRegistry::get();
+	for (const ModulesRegistry::Item *item : modulesRegistry->find(Module::READER, QString(), scheme))
+	{
+		if (item->info.type != Module::READER || (!plugName.isEmpty() && item->info.name != plugName))
+			continue;
+		if (reader.assign((Reader *)item->module->createInstance(item->info.name)))
+		{
+			reader->_url = url;
+			if (reader->open())
+				return true;
+			reader.reset();
+		}
+		if (reader.isAborted())
+			break;
+	}
 	return false;
 }
@@ -0,0 +1,566 @@
+/*
+	QMPlay2 is a video and audio player.
+	Copyright (C) 2010-2018  Błażej Szczygieł
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU Lesser General Public License as published
+	by the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <SampleConvert.hpp>
+
+#include <CPU.hpp>
+
+extern "C"
+{
+	#include <libavutil/cpu.h>
+}
+
+#if defined(QMPLAY2_CPU_X86)
+	#include <immintrin.h>
+#elif defined(QMPLAY2_CPU_ARM_NEON)
+	#include <arm_neon.h>
+#endif
+
+#include <cstring>
+
+/*
+ * Widening conversions are done backwards and narrowing conversions forwards,
+ * so every function can convert in-place.
+ */
+
+static void u8ToFloat_C(float *dst, const quint8 *src, int count)
+{
+	for (int i = count - 1; i >= 0; --i)
+		dst[i] = (src[i] - 0x7F) / 128.0f;
+}
+static void s8ToFloat_C(float *dst, const qint8 *src, int count)
+{
+	for (int i = count - 1; i >= 0; --i)
+		dst[i] = src[i] / 128.0f;
+}
+static void s16ToFloat_C(float *dst, const qint16 *src, int count, float scale)
+{
+	for (int i = count - 1; i >= 0; --i)
+		dst[i] = src[i] * scale;
+}
+static void s32ToFloat_C(float *dst, const qint32 *src, int count, float scale)
+{
+	for (int i = 0; i < count; ++i)
+		dst[i] = src[i] * scale;
+}
+static void dblToFloat_C(float *dst, const double *src, int count)
+{
+	for (int i = 0; i < count; ++i)
+		dst[i] = src[i];
+}
+static void interleave2_C(float *dst, const float *l, const float *r, int samples)
+{
+	for (int i = 0; i < samples; ++i)
+	{
+		*dst++ = l[i];
+		*dst++ = r[i];
+	}
+}
+static void interleave4_C(float *dst, const float *const *src, int stride, int begin, int end)
+{
+	//Writes 4 channels of frames from "begin" to "end", "stride" is the total channels count
+	for (int i = begin; i < end; ++i, dst += stride)
+	{
+		dst[0] = src[0][i];
+		dst[1] = src[1][i];
+		dst[2] = src[2][i];
+		dst[3] = src[3][i];
+	}
+}
+static void applyGain_C(float *data, int frames, int channels, const float *gains, float fade, float fadeStep)
+{
+	for (int f = 0; f < frames; ++f)
+	{
+		const float frameFade = qBound(0.0f, fade - f * fadeStep, 1.0f);
+		for (int c = 0; c < channels; ++c, ++data)
+			*data = qBound(-1.0f, *data * gains[c] * frameFade, 1.0f);
+	}
+}
+
+/*
+ * SIMD gain stage processes "blockFrames" frames at once using a tile of "channels * blockFrames"
+ * gains and fade offsets, so it works with any channel count up to "maxChannels".
+ */
+#define PREPARE_GAIN_TILE(blockFrames) \
+	const int tileSize = channels * blockFrames; \
+	float gainTile[SampleConvert::maxChannels * blockFrames], fadeTile[SampleConvert::maxChannels * blockFrames]; \
+	for (int i = 0; i < tileSize; ++i) \
+	{ \
+		gainTile[i] = gains[i % channels]; \
+		fadeTile[i] = (i / channels) * fadeStep; \
+	} \
+	const int simdFrames = frames - frames % blockFrames
+
+#ifdef QMPLAY2_CPU_X86
+__attribute__((target("sse2")))
+static inline void storeScaled_SSE2(float *dst, __m128i x, __m128 scale)
+{
+	_mm_storeu_ps(dst, _mm_mul_ps(_mm_cvtepi32_ps(x), scale));
+}
+__attribute__((target("sse2")))
+static void u8ToFloat_SSE2(float *dst, const quint8 *src, int count)
+{
+	const int simdCount = count & ~15;
+	u8ToFloat_C(dst + simdCount, src + simdCount, count - simdCount);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i bias = _mm_set1_epi32(0x7F);
+	const __m128 scale = _mm_set1_ps(1.0f / 128.0f);
+	for (int i = simdCount - 16; i >= 0; i -= 16)
+	{
+		const __m128i x = _mm_loadu_si128((const __m128i *)(src + i));
+		const __m128i lo = _mm_unpacklo_epi8(x, zero);
+		const __m128i hi = _mm_unpackhi_epi8(x, zero);
+		storeScaled_SSE2(dst + i +  0, _mm_sub_epi32(_mm_unpacklo_epi16(lo, zero), bias), scale);
+		storeScaled_SSE2(dst + i +  4, _mm_sub_epi32(_mm_unpackhi_epi16(lo, zero), bias), scale);
+		storeScaled_SSE2(dst + i +  8, _mm_sub_epi32(_mm_unpacklo_epi16(hi, zero), bias), scale);
+		storeScaled_SSE2(dst + i + 12, _mm_sub_epi32(_mm_unpackhi_epi16(hi, zero), bias), scale);
+	}
+}
+__attribute__((target("sse2")))
+static void s8ToFloat_SSE2(float *dst, const qint8 *src, int count)
+{
+	const int simdCount = count & ~15;
+	s8ToFloat_C(dst + simdCount, src + simdCount, count - simdCount);
+	const __m128 scale = _mm_set1_ps(1.0f / 128.0f);
+	for (int i = simdCount - 16; i >= 0; i -= 16)
+	{
+		const __m128i x = _mm_loadu_si128((const __m128i *)(src + i));
+		const __m128i lo = _mm_unpacklo_epi8(x, x);
+		const __m128i hi = _mm_unpackhi_epi8(x, x);
+		storeScaled_SSE2(dst + i +  0, _mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 24), scale);
+		storeScaled_SSE2(dst + i +  4, _mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 24), scale);
+		storeScaled_SSE2(dst + i +  8, _mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 24), scale);
+		storeScaled_SSE2(dst + i + 12, _mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 24), scale);
+	}
+}
+__attribute__((target("sse2")))
+static void s16ToFloat_SSE2(float *dst, const qint16 *src, int count, float scaleValue)
+{
+	const int simdCount = count & ~7;
+	s16ToFloat_C(dst + simdCount, src + simdCount, count - simdCount, scaleValue);
+	const __m128 scale = _mm_set1_ps(scaleValue);
+	for (int i = simdCount - 8; i >= 0; i -= 8)
+	{
+		const __m128i x = _mm_loadu_si128((const __m128i *)(src + i));
+		storeScaled_SSE2(dst + i + 0, _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16), scale);
+		storeScaled_SSE2(dst + i + 4, _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16), scale);
+	}
+}
+__attribute__((target("sse2")))
+static void s32ToFloat_SSE2(float *dst, const qint32 *src, int count, float scaleValue)
+{
+	const int simdCount = count & ~3;
+	const __m128 scale = _mm_set1_ps(scaleValue);
+	for (int i = 0; i < simdCount; i += 4)
+		storeScaled_SSE2(dst + i, _mm_loadu_si128((const __m128i *)(src + i)), scale);
+	s32ToFloat_C(dst + simdCount, src + simdCount, count - simdCount, scaleValue);
+}
+__attribute__((target("sse2")))
+static void dblToFloat_SSE2(float *dst, const double *src, int count)
+{
+	const int simdCount = count & ~3;
+	for (int i = 0; i < simdCount; i += 4)
+	{
+		const __m128 lo = _mm_cvtpd_ps(_mm_loadu_pd(src + i + 0));
+		const __m128 hi = _mm_cvtpd_ps(_mm_loadu_pd(src + i + 2));
+		_mm_storeu_ps(dst + i, _mm_movelh_ps(lo, hi));
+	}
+	dblToFloat_C(dst + simdCount, src + simdCount, count - simdCount);
+}
+__attribute__((target("sse2")))
+static void interleave2_SSE2(float *dst, const float *l, const float *r, int samples)
+{
+	const int simdCount = samples & ~3;
+	for (int i = 0; i < simdCount; i += 4)
+	{
+		const __m128 x = _mm_loadu_ps(l + i);
+		const __m128 y = _mm_loadu_ps(r + i);
+		_mm_storeu_ps(dst + 2 * i + 0, _mm_unpacklo_ps(x, y));
+		_mm_storeu_ps(dst + 2 * i + 4, _mm_unpackhi_ps(x, y));
+	}
+	interleave2_C(dst + 2 * simdCount, l + simdCount, r + simdCount, samples - simdCount);
+}
+__attribute__((target("sse2")))
+static void interleave4_SSE2(float *dst, const float *const *src, int stride, int begin, int end)
+{
+	const int simdEnd = begin + ((end - begin) & ~3);
+	for (int i = begin; i < simdEnd; i += 4, dst += 4 * stride)
+	{
+		__m128 x0 = _mm_loadu_ps(src[0] + i);
+		__m128 x1 = _mm_loadu_ps(src[1] + i);
+		__m128 x2 = _mm_loadu_ps(src[2] + i);
+		__m128 x3 = _mm_loadu_ps(src[3] + i);
+		_MM_TRANSPOSE4_PS(x0, x1, x2, x3);
+		_mm_storeu_ps(dst + 0 * stride, x0);
+		_mm_storeu_ps(dst + 1 * stride, x1);
+		_mm_storeu_ps(dst + 2 * stride, x2);
+		_mm_storeu_ps(dst + 3 * stride, x3);
+	}
+	interleave4_C(dst, src, stride, simdEnd, end);
+}
+__attribute__((target("sse2")))
+static void applyGain_SSE2(float *data, int frames, int channels, const float *gains, float fade, float fadeStep)
+{
+	PREPARE_GAIN_TILE(4);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 minusOne = _mm_set1_ps(-1.0f);
+	for (int f = 0; f < simdFrames; f += 4)
+	{
+		const __m128 blockFade = _mm_set1_ps(fade - f * fadeStep);
+		for (int i = 0; i < tileSize; i += 4, data += 4)
+		{
+			const __m128 frameFade = _mm_min_ps(_mm_max_ps(_mm_sub_ps(blockFade, _mm_loadu_ps(fadeTile + i)), zero), one);
+			const __m128 x = _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(data), _mm_loadu_ps(gainTile + i)), frameFade);
+			_mm_storeu_ps(data, _mm_min_ps(_mm_max_ps(x, minusOne), one));
+		}
+	}
+	applyGain_C(data, frames - simdFrames, channels, gains, fade - simdFrames * fadeStep, fadeStep);
+}
+
+__attribute__((target("avx2")))
+static inline void storeScaled_AVX2(float *dst, __m256i x, __m256 scale)
+{
+	_mm256_storeu_ps(dst, _mm256_mul_ps(_mm256_cvtepi32_ps(x), scale));
+}
+__attribute__((target("avx2")))
+static void u8ToFloat_AVX2(float *dst, const quint8 *src, int count)
+{
+	const int simdCount = count & ~15;
+	u8ToFloat_C(dst + simdCount, src + simdCount, count - simdCount);
+	const __m256i bias = _mm256_set1_epi32(0x7F);
+	const __m256 scale = _mm256_set1_ps(1.0f / 128.0f);
+	for (int i = simdCount - 16; i >= 0; i -= 16)
+	{
+		const __m128i x = _mm_loadu_si128((const __m128i *)(src + i));
+		storeScaled_AVX2(dst + i + 0, _mm256_sub_epi32(_mm256_cvtepu8_epi32(x), bias), scale);
+		storeScaled_AVX2(dst + i + 8, _mm256_sub_epi32(_mm256_cvtepu8_epi32(_mm_srli_si128(x, 8)), bias), scale);
+	}
+}
+__attribute__((target("avx2")))
+static void s8ToFloat_AVX2(float *dst, const qint8 *src, int count)
+{
+	const int simdCount = count & ~15;
+	s8ToFloat_C(dst + simdCount, src + simdCount, count - simdCount);
+	const __m256 scale = _mm256_set1_ps(1.0f / 128.0f);
+	for (int i = simdCount - 16; i >= 0; i -= 16)
+	{
+		const __m128i x = _mm_loadu_si128((const __m128i *)(src + i));
+		storeScaled_AVX2(dst + i + 0, _mm256_cvtepi8_epi32(x), scale);
+		storeScaled_AVX2(dst + i + 8, _mm256_cvtepi8_epi32(_mm_srli_si128(x, 8)), scale);
+	}
+}
+__attribute__((target("avx2")))
+static void s16ToFloat_AVX2(float *dst, const qint16 *src, int count, float scaleValue)
+{
+	const int simdCount = count & ~15;
+	s16ToFloat_C(dst + simdCount, src + simdCount, count - simdCount, scaleValue);
+	const __m256 scale = _mm256_set1_ps(scaleValue);
+	for (int i = simdCount - 16; i >= 0; i -= 16)
+	{
+		//Load everything before storing - the output can overlap the input
+		const __m256i lo = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(src + i + 0)));
+		const __m256i hi = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(src + i + 8)));
+		storeScaled_AVX2(dst + i + 0, lo, scale);
+		storeScaled_AVX2(dst + i + 8, hi, scale);
+	}
+}
+__attribute__((target("avx2")))
+static void s32ToFloat_AVX2(float *dst, const qint32 *src, int count, float scaleValue)
+{
+	const int simdCount = count & ~7;
+	const __m256 scale = _mm256_set1_ps(scaleValue);
+	for (int i = 0; i < simdCount; i += 8)
+		storeScaled_AVX2(dst + i, _mm256_loadu_si256((const __m256i *)(src + i)), scale);
+	s32ToFloat_C(dst + simdCount, src + simdCount, count - simdCount, scaleValue);
+}
+__attribute__((target("avx2")))
+static void dblToFloat_AVX2(float *dst, const double *src, int count)
+{
+	const int simdCount = count & ~7;
+	for (int i = 0; i < simdCount; i += 8)
+	{
+		const __m128 lo = _mm256_cvtpd_ps(_mm256_loadu_pd(src + i + 0));
+		const __m128 hi = _mm256_cvtpd_ps(_mm256_loadu_pd(src + i + 4));
+		_mm_storeu_ps(dst + i + 0, lo);
+		_mm_storeu_ps(dst + i + 4, hi);
+	}
+	dblToFloat_C(dst + simdCount, src + simdCount, count - simdCount);
+}
+__attribute__((target("avx2")))
+static void applyGain_AVX2(float *data, int frames, int channels, const float *gains, float fade, float fadeStep)
+{
+	PREPARE_GAIN_TILE(8);
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 minusOne = _mm256_set1_ps(-1.0f);
+	for (int f = 0; f < simdFrames; f += 8)
+	{
+		const __m256 blockFade = _mm256_set1_ps(fade - f * fadeStep);
+		for (int i = 0; i < tileSize; i += 8, data += 8)
+		{
+			const __m256 frameFade = _mm256_min_ps(_mm256_max_ps(_mm256_sub_ps(blockFade, _mm256_loadu_ps(fadeTile + i)), zero), one);
+			const __m256 x = _mm256_mul_ps(_mm256_mul_ps(_mm256_loadu_ps(data), _mm256_loadu_ps(gainTile + i)), frameFade);
+			_mm256_storeu_ps(data, _mm256_min_ps(_mm256_max_ps(x, minusOne), one));
+		}
+	}
+	applyGain_C(data, frames - simdFrames, channels, gains, fade - simdFrames * fadeStep, fadeStep);
+}
+#endif // QMPLAY2_CPU_X86
+
+#ifdef QMPLAY2_CPU_ARM_NEON
+static inline void storeScaled_NEON(float *dst, int32x4_t x, float scale)
+{
+	vst1q_f32(dst, vmulq_n_f32(vcvtq_f32_s32(x), scale));
+}
+static void u8ToFloat_NEON(float *dst, const quint8 *src, int count)
+{
+	const int simdCount = count & ~7;
+	u8ToFloat_C(dst + simdCount, src + simdCount, count - simdCount);
+	const int32x4_t bias = vdupq_n_s32(0x7F);
+	for (int i = simdCount - 8; i >= 0; i -= 8)
+	{
+		const uint16x8_t x = vmovl_u8(vld1_u8(src + i));
+		storeScaled_NEON(dst + i + 0, vsubq_s32(vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(x))), bias), 1.0f / 128.0f);
+		storeScaled_NEON(dst + i + 4, vsubq_s32(vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(x))), bias), 1.0f / 128.0f);
+	}
+}
+static void s8ToFloat_NEON(float *dst, const qint8 *src, int count)
+{
+	const int simdCount = count & ~7;
+	s8ToFloat_C(dst + simdCount, src + simdCount, count - simdCount);
+	for (int i = simdCount - 8; i >= 0; i -= 8)
+	{
+		const int16x8_t x = vmovl_s8(vld1_s8(src + i));
+		storeScaled_NEON(dst + i + 0, vmovl_s16(vget_low_s16(x)), 1.0f / 128.0f);
+		storeScaled_NEON(dst + i + 4, vmovl_s16(vget_high_s16(x)), 1.0f / 128.0f);
+	}
+}
+static void s16ToFloat_NEON(float *dst, const qint16 *src, int count, float scale)
+{
+	const int simdCount = count & ~7;
+	s16ToFloat_C(dst + simdCount, src + simdCount, count - simdCount, scale);
+	for (int i = simdCount - 8; i >= 0; i -= 8)
+	{
+		const int16x8_t x = vld1q_s16(src + i);
+		storeScaled_NEON(dst + i + 0, vmovl_s16(vget_low_s16(x)), scale);
+		storeScaled_NEON(dst + i + 4, vmovl_s16(vget_high_s16(x)), scale);
+	}
+}
+static void s32ToFloat_NEON(float *dst, const qint32 *src, int count, float scale)
+{
+	const int simdCount = count & ~3;
+	for (int i = 0; i < simdCount; i += 4)
+		storeScaled_NEON(dst + i, vld1q_s32(src + i), scale);
+	s32ToFloat_C(dst + simdCount, src + simdCount, count - simdCount, scale);
+}
+static void interleave2_NEON(float *dst, const float *l, const float *r, int samples)
+{
+	const int simdCount = samples & ~3;
+	for (int i = 0; i < simdCount; i += 4)
+	{
+		float32x4x2_t x;
+		x.val[0] = vld1q_f32(l + i);
+		x.val[1] = vld1q_f32(r + i);
+		vst2q_f32(dst + 2 * i, x);
+	}
+	interleave2_C(dst + 2 * simdCount, l + simdCount, r + simdCount, samples - simdCount);
+}
+static void interleave4_NEON(float *dst, const float *const *src, int stride, int begin, int end)
+{
+	const int simdEnd = begin + ((end - begin) & ~3);
+	for (int i = begin; i < simdEnd; i += 4, dst += 4 * stride)
+	{
+		const float32x4x2_t x01 = vtrnq_f32(vld1q_f32(src[0] + i), vld1q_f32(src[1] + i));
+		const float32x4x2_t x23 = vtrnq_f32(vld1q_f32(src[2] + i), vld1q_f32(src[3] + i));
+		vst1q_f32(dst + 0 * stride, vcombine_f32(vget_low_f32(x01.val[0]), vget_low_f32(x23.val[0])));
+		vst1q_f32(dst + 1 * stride, vcombine_f32(vget_low_f32(x01.val[1]), vget_low_f32(x23.val[1])));
+		vst1q_f32(dst + 2 * stride, vcombine_f32(vget_high_f32(x01.val[0]), vget_high_f32(x23.val[0])));
+		vst1q_f32(dst + 3 * stride, vcombine_f32(vget_high_f32(x01.val[1]), vget_high_f32(x23.val[1])));
+	}
+	interleave4_C(dst, src, stride, simdEnd, end);
+}
+static void applyGain_NEON(float *data, int frames, int channels, const float *gains, float fade, float fadeStep)
+{
+	PREPARE_GAIN_TILE(4);
+	const float32x4_t zero = vdupq_n_f32(0.0f);
+	const float32x4_t one = vdupq_n_f32(1.0f);
+	const float32x4_t minusOne = vdupq_n_f32(-1.0f);
+	for (int f = 0; f < simdFrames; f += 4)
+	{
+		const float32x4_t blockFade = vdupq_n_f32(fade - f * fadeStep);
+		for (int i = 0; i < tileSize; i += 4, data += 4)
+		{
+			const float32x4_t frameFade = vminq_f32(vmaxq_f32(vsubq_f32(blockFade, vld1q_f32(fadeTile + i)), zero), one);
+			const float32x4_t x = vmulq_f32(vmulq_f32(vld1q_f32(data), vld1q_f32(gainTile + i)), frameFade);
+			vst1q_f32(data, vminq_f32(vmaxq_f32(x, minusOne), one));
+		}
+	}
+	applyGain_C(data, frames - simdFrames, channels, gains, fade - simdFrames * fadeStep, fadeStep);
+}
+#endif // QMPLAY2_CPU_ARM_NEON
+
+/**/
+
+struct ConvertFunctions
+{
+	ConvertFunctions()
+	{
+		u8ToFloat = u8ToFloat_C;
+		s8ToFloat = s8ToFloat_C;
+		s16ToFloat = s16ToFloat_C;
+		s32ToFloat = s32ToFloat_C;
+		dblToFloat = dblToFloat_C;
+		interleave2 = interleave2_C;
+		interleave4 = interleave4_C;
+		applyGain = applyGain_C;
+#ifdef QMPLAY2_CPU_X86
+		const int cpuFlags = av_get_cpu_flags();
+		if (cpuFlags & AV_CPU_FLAG_SSE2)
+		{
+			u8ToFloat = u8ToFloat_SSE2;
+			s8ToFloat = s8ToFloat_SSE2;
+			s16ToFloat = s16ToFloat_SSE2;
+			s32ToFloat = s32ToFloat_SSE2;
+			dblToFloat = dblToFloat_SSE2;
+			interleave2 = interleave2_SSE2;
+			interleave4 = interleave4_SSE2;
+			applyGain = applyGain_SSE2;
+		}
+		if (cpuFlags & AV_CPU_FLAG_AVX2)
+		{
+			u8ToFloat = u8ToFloat_AVX2;
+			s8ToFloat = s8ToFloat_AVX2;
+			s16ToFloat = s16ToFloat_AVX2;
+			s32ToFloat = s32ToFloat_AVX2;
+			dblToFloat = dblToFloat_AVX2;
+			applyGain = applyGain_AVX2;
+		}
+#elif defined(QMPLAY2_CPU_ARM_NEON)
+		u8ToFloat = u8ToFloat_NEON;
+		s8ToFloat = s8ToFloat_NEON;
+		s16ToFloat = s16ToFloat_NEON;
+		s32ToFloat = s32ToFloat_NEON;
+		interleave2 = interleave2_NEON;
+		interleave4 = interleave4_NEON;
+		applyGain = applyGain_NEON;
+#endif // QMPLAY2_CPU_X86
+	}
+
+	void (*u8ToFloat)(float *dst, const quint8 *src, int count);
+	void (*s8ToFloat)(float *dst, const qint8 *src, int count);
+	void (*s16ToFloat)(float *dst, const qint16 *src, int count, float scale);
+	void (*s32ToFloat)(float *dst, const qint32 *src, int count, float scale);
+	void (*dblToFloat)(float *dst, const double *src, int count);
+	void (*interleave2)(float *dst, const float *l, const float *r, int samples);
+	void (*interleave4)(float *dst, const float *const *src, int stride, int begin, int end);
+	void (*applyGain)(float *data, int frames, int channels, const float *gains, float fade, float fadeStep);
+};
+
+static inline const ConvertFunctions &impl()
+{
+	static const ConvertFunctions convertFunctions;
+	return convertFunctions;
+}
+
+static const float *convertPlane(SampleConvert::Format fmt, float *tmp, const void *plane, int offset, int count)
+{
+	switch (fmt)
+	{
+		case SampleConvert::U8:
+			impl().u8ToFloat(tmp, (const quint8 *)plane + offset, count);
+			break;
+		case SampleConvert::S16:
+			impl().s16ToFloat(tmp, (const qint16 *)plane + offset, count, 1.0f / 32768.0f);
+			break;
+		case SampleConvert::S32:
+			impl().s32ToFloat(tmp, (const qint32 *)plane + offset, count, 1.0f / 2147483648.0f);
+			break;
+		case SampleConvert::FLT:
+			return (const float *)plane + offset;
+		case SampleConvert::DBL:
+			impl().dblToFloat(tmp, (const double *)plane + offset, count);
+			break;
+	}
+	return tmp;
+}
+
+void SampleConvert::u8ToFloat(float *dst, const quint8 *src, int count)
+{
+	impl().u8ToFloat(dst, src, count);
+}
+void SampleConvert::s8ToFloat(float *dst, const qint8 *src, int count)
+{
+	impl().s8ToFloat(dst, src, count);
+}
+void SampleConvert::s16ToFloat(float *dst, const qint16 *src, int count, float scale)
+{
+	impl().s16ToFloat(dst, src, count, scale);
+}
+void SampleConvert::s32ToFloat(float *dst, const qint32 *src, int count, float scale)
+{
+	impl().s32ToFloat(dst, src, count, scale);
+}
+void SampleConvert::dblToFloat(float *dst, const double *src, int count)
+{
+	impl().dblToFloat(dst, src, count);
+}
+
+void SampleConvert::applyGain(float *data, int frames, int channels, const float *gains, float fade, float fadeStep)
+{
+	impl().applyGain(data, frames, channels, gains, fade, fadeStep);
+}
+
+void SampleConvert::planarToFloat(Format fmt, float *dst, const void *const *src, int channels, int samples)
+{
+	constexpr int tmpSize = 4096; //Small enough to keep temporary planes in L1 cache
+	float tmp[tmpSize];
+	const float *planes[maxChannels];
+	const int blockSize = qMin(256, tmpSize / qMax(channels, 2)); //At least 16 samples for "maxChannels"
+	for (int offset = 0; offset < samples; offset += blockSize)
+	{
+		const int count = qMin(blockSize, samples - offset);
+		float *out = dst + offset * channels;
+		if (channels == 1)
+		{
+			const float *plane = convertPlane(fmt, out, src[0], offset, count);
+			if (plane != out)
+				memcpy(out, plane, count * sizeof(float));
+		}
+		else if (channels == 2)
+		{
+			const float *l = convertPlane(fmt, tmp, src[0], offset, count);
+			const float *r = convertPlane(fmt, tmp + blockSize, src[1], offset, count);
+			impl().interleave2(out, l, r, count);
+		}
+		else
+		{
+			//Convert all planes of the block first, then interleave them by 4 channels
+			for (int ch = 0; ch < channels; ++ch)
+				planes[ch] = convertPlane(fmt, tmp + ch * blockSize, src[ch], offset, count);
+			int ch = 0;
+			for (; ch + 4 <= channels; ch += 4)
+				impl().interleave4(out + ch, planes + ch, channels, 0, count);
+			for (; ch < channels; ++ch)
+			{
+				for (int i = 0; i < count; ++i)
+					out[i * channels + ch] = planes[ch][i];
+			}
+		}
+	}
+}
@@ -18,6 +18,7 @@
 
 #include <Settings.hpp>
 
+#include <ModulesRegistry.hpp>
 #include <CppUtils.hpp>
 
 Settings::Settings(const QString &name) :
@@ -57,12 +58,14 @@ void Settings::set(const QString &key, const QVariant &val)
 	QMutexLocker mL(&mutex);
 	toRemove.remove(key);
 	cache[key] = val;
+	ModulesRegistry::invalidate(); //Modules can be enabled or disabled
 }
 void Settings::remove(const QString &key)
 {
 	QMutexLocker mL(&mutex);
 	toRemove.insert(key);
 	cache.remove(key);
+	ModulesRegistry::invalidate();
 }
 
 QVariant Settings::get(const QString &key, const QVariant &def) const
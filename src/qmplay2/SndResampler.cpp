@@ -17,6 +17,7 @@
 */
 
 #include <SndResampler.hpp>
+#include <Buffer.hpp>
 
 #include <QByteArray>
 
@@ -26,6 +27,7 @@ extern "C"
 {
 #ifdef QMPLAY2_AVRESAMPLE
 	#include <libavresample/avresample.h>
+	#include <libavutil/mathematics.h>
 	#include <libavutil/samplefmt.h>
 	#define set_matrix avresample_set_matrix
 #else
@@ -93,25 +95,32 @@ bool SndResampler::create(int _src_samplerate, int _src_channels, int _dst_sampl
 	}
 	return true;
 }
-void SndResampler::convert(const QByteArray &src, QByteArray &dst)
+void SndResampler::convert(const QByteArray &src, Buffer &dst)
 {
 	const int in_size = src.size() / src_channels / sizeof(float);
 	const int out_size = ceil(in_size * (double)dst_samplerate / (double)src_samplerate);
-
-	dst.reserve(out_size * sizeof(float) * dst_channels);
-
-	const quint8 *in[] = {(const quint8 *)src.constData()};
-	quint8 *out[] = {(quint8 *)dst.data()};
-
+	convert((const quint8 *)src.constData(), in_size, out_size, dst);
+}
+void SndResampler::flush(Buffer &dst)
+{
 #ifdef QMPLAY2_AVRESAMPLE
-	const int converted = avresample_convert(snd_convert_ctx, out, 1, out_size, (quint8 *const *)in, 1, in_size);
+	const int out_size = avresample_available(snd_convert_ctx) + av_rescale_rnd(avresample_get_delay(snd_convert_ctx), dst_samplerate, src_samplerate, AV_ROUND_UP);
 #else
-	const int converted = swr_convert(snd_convert_ctx, out, out_size, in, in_size);
+	const int out_size = swr_get_out_samples(snd_convert_ctx, 0);
 #endif
-	if (converted > 0)
-		dst.resize(converted * sizeof(float) * dst_channels);
+	if (out_size > 0)
+		convert(nullptr, 0, out_size, dst);
 	else
-		dst.clear();
+		dst.resize(0);
+
+	//Start again with empty internal buffers
+#ifdef QMPLAY2_AVRESAMPLE
+	avresample_close(snd_convert_ctx);
+	if (avresample_open(snd_convert_ctx))
+#else
+	if (swr_init(snd_convert_ctx))
+#endif
+		destroy();
 }
 void SndResampler::destroy()
 {
@@ -121,3 +130,20 @@ void SndResampler::destroy()
 	swr_free(&snd_convert_ctx);
 #endif
 }
+
+void SndResampler::convert(const quint8 *in, int in_size, int out_size, Buffer &dst)
+{
+	if (dst.offset() > 0) //Can't be resized
+		dst.clear();
+	dst.resize(out_size * sizeof(float) * dst_channels); //Allocates only if the buffer is too small
+
+	const quint8 *inArr[] = {in};
+	quint8 *out[] = {dst.data()};
+
+#ifdef QMPLAY2_AVRESAMPLE
+	const int converted = avresample_convert(snd_convert_ctx, out, 1, out_size, in ? (quint8 *const *)inArr : nullptr, in ? 1 : 0, in_size);
+#else
+	const int converted = swr_convert(snd_convert_ctx, out, out_size, in ? inArr : nullptr, in_size);
+#endif
+	dst.resize((converted > 0) ? converted * sizeof(float) * dst_channels : 0);
+}
@@ -17,29 +17,29 @@
 */
 
 #include <SubsDec.hpp>
-#include <Module.hpp>
+#include <ModulesRegistry.hpp>
 
 SubsDec *SubsDec::create(const QString &type)
 {
 	if (type.isEmpty())
 		return nullptr;
-	for (Module *module : QMPlay2Core.getPluginsInstance())
-		for (const Module::Info &mod : module->getModulesInfo())
-			if (mod.type == Module::SUBSDEC && mod.extensions.contains(type))
-			{
-				SubsDec *subsdec = (SubsDec *)module->createInstance(mod.name);
-				if (!subsdec)
-					continue;
-				return subsdec;
-			}
+	const auto modulesRegistry = ModulesRegistry::get();
+	for (const ModulesRegistry::Item *item : modulesRegistry->find(Module::SUBSDEC, QString(), type))
+		if (item->info.type == Module::SUBSDEC)
+		{
+			SubsDec *subsdec = (SubsDec *)item->module->createInstance(item->info.name);
+			if (!subsdec)
+				continue;
+			return subsdec;
+		}
 	return nullptr;
 }
 QStringList SubsDec::extensions()
 {
 	QStringList extensions;
-	for (const Module *module : QMPlay2Core.getPluginsInstance())
-		for (const Module::Info &mod : module->getModulesInfo())
-			if (mod.type == Module::SUBSDEC)
-				extensions << mod.extensions;
+	const auto modulesRegistry = ModulesRegistry::get();
+	for (const ModulesRegistry::Item &item : modulesRegistry->items(Module::SUBSDEC))
+		if (item.info.type == Module::SUBSDEC)
+			extensions << item.info.extensions;
 	return extensions;
 }
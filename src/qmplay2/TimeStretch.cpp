@@ -0,0 +1,378 @@
+/*
+	QMPlay2 is a video and audio player.
+	Copyright (C) 2010-2018  Błażej Szczygieł
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU Lesser General Public License as published
+	by the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <TimeStretch.hpp>
+
+#include <Buffer.hpp>
+#include <CPU.hpp>
+
+extern "C"
+{
+	#include <libavutil/cpu.h>
+}
+
+#if defined(QMPLAY2_CPU_X86)
+	#include <immintrin.h>
+#elif defined(QMPLAY2_CPU_ARM_NEON)
+	#include <arm_neon.h>
+#endif
+
+#include <cstring>
+#include <cmath>
+
+static constexpr double g_windowLen = 0.030;
+static constexpr double g_seekLen = 0.010;
+static constexpr int g_refineLen = 3;
+
+static float dotProduct_C(const float *a, const float *b, int count)
+{
+	float sum = 0.0f;
+	for (int i = 0; i < count; ++i)
+		sum += a[i] * b[i];
+	return sum;
+}
+
+#ifdef QMPLAY2_CPU_X86
+__attribute__((target("sse2")))
+static float dotProduct_SSE2(const float *a, const float *b, int count)
+{
+	const int simdCount = count & ~7;
+	__m128 sum1 = _mm_setzero_ps();
+	__m128 sum2 = _mm_setzero_ps();
+	for (int i = 0; i < simdCount; i += 8)
+	{
+		sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(a + i + 0), _mm_loadu_ps(b + i + 0)));
+		sum2 = _mm_add_ps(sum2, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+	}
+	sum1 = _mm_add_ps(sum1, sum2);
+	sum1 = _mm_add_ps(sum1, _mm_movehl_ps(sum1, sum1));
+	sum1 = _mm_add_ss(sum1, _mm_shuffle_ps(sum1, sum1, 1));
+	return _mm_cvtss_f32(sum1) + dotProduct_C(a + simdCount, b + simdCount, count - simdCount);
+}
+
+__attribute__((target("avx2")))
+static float dotProduct_AVX2(const float *a, const float *b, int count)
+{
+	const int simdCount = count & ~15;
+	__m256 sum1 = _mm256_setzero_ps();
+	__m256 sum2 = _mm256_setzero_ps();
+	for (int i = 0; i < simdCount; i += 16)
+	{
+		sum1 = _mm256_add_ps(sum1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 0), _mm256_loadu_ps(b + i + 0)));
+		sum2 = _mm256_add_ps(sum2, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+	}
+	sum1 = _mm256_add_ps(sum1, sum2);
+	__m128 sum = _mm_add_ps(_mm256_castps256_ps128(sum1), _mm256_extractf128_ps(sum1, 1));
+	sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+	sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+	return _mm_cvtss_f32(sum) + dotProduct_C(a + simdCount, b + simdCount, count - simdCount);
+}
+#endif // QMPLAY2_CPU_X86
+
+#ifdef QMPLAY2_CPU_ARM_NEON
+static float dotProduct_NEON(const float *a, const float *b, int count)
+{
+	const int simdCount = count & ~7;
+	float32x4_t sum1 = vdupq_n_f32(0.0f);
+	float32x4_t sum2 = vdupq_n_f32(0.0f);
+	for (int i = 0; i < simdCount; i += 8)
+	{
+		sum1 = vmlaq_f32(sum1, vld1q_f32(a + i + 0), vld1q_f32(b + i + 0));
+		sum2 = vmlaq_f32(sum2, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+	}
+	sum1 = vaddq_f32(sum1, sum2);
+	const float32x2_t sum = vadd_f32(vget_low_f32(sum1), vget_high_f32(sum1));
+	return vget_lane_f32(vpadd_f32(sum, sum), 0) + dotProduct_C(a + simdCount, b + simdCount, count - simdCount);
+}
+#endif // QMPLAY2_CPU_ARM_NEON
+
+static float dotProduct(const float *a, const float *b, int count)
+{
+	static float (*const fn)(const float *, const float *, int) = [] {
+#ifdef QMPLAY2_CPU_X86
+		const int cpuFlags = av_get_cpu_flags();
+		if (cpuFlags & AV_CPU_FLAG_AVX2)
+			return dotProduct_AVX2;
+		if (cpuFlags & AV_CPU_FLAG_SSE2)
+			return dotProduct_SSE2;
+#elif defined(QMPLAY2_CPU_ARM_NEON)
+		return dotProduct_NEON;
+#endif
+		return dotProduct_C;
+	}();
+	return fn(a, b, count);
+}
+
+/**/
+
+void TimeStretch::setParams(int channels, int sampleRate)
+{
+	if (channels == m_channels && sampleRate == m_sampleRate)
+		return;
+
+	m_channels = channels;
+	m_sampleRate = sampleRate;
+
+	m_hop = qMax<int>(16, sampleRate * g_windowLen / 2.0);
+	m_seek = qMax<int>(8, sampleRate * g_seekLen);
+	m_coarseStep = qMax(1, sampleRate / 12000);
+
+	m_rise.resize(m_hop);
+	m_fall.resize(m_hop);
+	for (int i = 0; i < m_hop; ++i)
+	{
+		m_rise[i] = 0.5 - 0.5 * cos(M_PI * i / m_hop);
+		m_fall[i] = 1.0f - m_rise[i];
+	}
+
+	m_overlap.resize(m_hop * m_channels);
+	m_template.resize(m_hop);
+
+	clear();
+}
+void TimeStretch::setSpeed(double speed)
+{
+	m_speed = (speed > 0.0) ? speed : 1.0;
+}
+
+double TimeStretch::delay() const
+{
+	if (m_sampleRate <= 0)
+		return 0.0;
+	if (!m_started)
+		return (double)m_inputFrames / m_sampleRate;
+	return qMax(0.0, m_inputFrames - m_position) / m_sampleRate;
+}
+
+void TimeStretch::clear()
+{
+	m_inputFrames = 0;
+	m_started = false;
+	m_prevPos = 0;
+	m_position = 0.0;
+}
+
+void TimeStretch::process(const float *src, int frames, Buffer &dst)
+{
+	if (dst.offset() > 0) //Can't be resized
+		dst.clear();
+
+	appendInput(src, frames);
+
+	if (m_speed == 1.0)
+	{
+		//The pending falling half added to the rising half of the same samples gives the input back
+		const int pos = m_started ? m_prevPos + m_hop : 0;
+		const int size = (m_inputFrames - pos) * m_channels * sizeof(float);
+		dst.resize(size);
+		memcpy(dst.data(), m_input.constData() + pos * m_channels, size);
+		clear();
+		return;
+	}
+
+	if (!m_started)
+	{
+		if (m_inputFrames < m_hop)
+		{
+			dst.resize(0);
+			return;
+		}
+		//Start as if the previous segment ended just before the first sample
+		const float *input = m_input.constData();
+		float *overlap = m_overlap.data();
+		for (int i = 0; i < m_hop; ++i)
+			for (int c = 0; c < m_channels; ++c, ++input, ++overlap)
+				*overlap = *input * m_fall[i];
+		m_prevPos = -m_hop;
+		m_position = 0.0;
+		m_started = true;
+	}
+
+	const double step = m_hop * m_speed;
+	const int lastPos = m_inputFrames - 2 * m_hop - m_seek; //The last nominal position with enough input
+	const int segments = (lastPos >= m_position) ? (lastPos - m_position) / step + 1 : 0;
+
+	dst.resize(segments * m_hop * m_channels * sizeof(float));
+	float *out = (float *)dst.data();
+
+	for (int s = 0; s < segments; ++s)
+	{
+		const int nominalPos = m_position;
+		const int pos = findBestPosition(qMax(0, nominalPos - m_seek), nominalPos + m_seek);
+		overlapAdd(out, pos);
+		out += m_hop * m_channels;
+		m_prevPos = pos;
+		m_position += step;
+	}
+
+	discardInput(qMax(0, qMin<int>(m_prevPos + m_hop, m_position - m_seek)));
+}
+
+void TimeStretch::flush(Buffer &dst)
+{
+	if (dst.offset() > 0) //Can't be resized
+		dst.clear();
+
+	if (m_speed == 1.0 || !m_started)
+	{
+		//Not enough input for a segment, write it unchanged
+		const int pos = m_started ? m_prevPos + m_hop : 0;
+		const int size = qMax(0, m_inputFrames - pos) * m_channels * sizeof(float);
+		dst.resize(size);
+		if (size > 0)
+			memcpy(dst.data(), m_input.constData() + pos * m_channels, size);
+		clear();
+		return;
+	}
+
+	//Pad the input with silence, so the segments at the remaining nominal positions can be found
+	const int inputEnd = m_inputFrames;
+	const int padding = 2 * m_hop + m_seek;
+	if (m_input.size() < (inputEnd + padding) * m_channels)
+		m_input.resize((inputEnd + padding) * m_channels);
+	memset(m_input.data() + inputEnd * m_channels, 0, padding * m_channels * sizeof(float));
+	m_inputFrames += padding;
+
+	const double step = m_hop * m_speed;
+	const int segments = (inputEnd > m_position) ? ceil((inputEnd - m_position) / step) : 0;
+
+	//The falling half of the last segment ends the output
+	dst.resize((segments + 1) * m_hop * m_channels * sizeof(float));
+	float *out = (float *)dst.data();
+
+	for (int s = 0; s < segments; ++s)
+	{
+		const int nominalPos = m_position;
+		const int pos = findBestPosition(qMax(0, nominalPos - m_seek), nominalPos + m_seek);
+		overlapAdd(out, pos);
+		out += m_hop * m_channels;
+		m_prevPos = pos;
+		m_position += step;
+	}
+	memcpy(out, m_overlap.constData(), m_hop * m_channels * sizeof(float));
+
+	clear();
+}
+
+void TimeStretch::appendInput(const float *src, int frames)
+{
+	const int newFrames = m_inputFrames + frames;
+	if (m_input.size() < newFrames * m_channels)
+		m_input.resize(newFrames * m_channels);
+	memcpy(m_input.data() + m_inputFrames * m_channels, src, frames * m_channels * sizeof(float));
+	m_inputFrames = newFrames;
+}
+void TimeStretch::discardInput(int frames)
+{
+	if (frames <= 0)
+		return;
+	m_inputFrames -= frames;
+	memmove(m_input.data(), m_input.constData() + frames * m_channels, m_inputFrames * m_channels * sizeof(float));
+	m_prevPos -= frames;
+	m_position -= frames;
+}
+
+int TimeStretch::findBestPosition(int minPos, int maxPos)
+{
+	const int count = maxPos - minPos + 1;
+	const int monoLen = count + m_hop - 1;
+
+	//Mono mix of the search region and of the continuation of the previous segment
+	if (m_mono.size() < monoLen)
+		m_mono.resize(monoLen);
+	float *mono = m_mono.data();
+	const float *input = m_input.constData() + minPos * m_channels;
+	for (int i = 0; i < monoLen; ++i)
+	{
+		float sum = 0.0f;
+		for (int c = 0; c < m_channels; ++c)
+			sum += *input++;
+		mono[i] = sum;
+	}
+	float *tmpl = m_template.data();
+	input = m_input.constData() + (m_prevPos + m_hop) * m_channels;
+	for (int i = 0; i < m_hop; ++i)
+	{
+		float sum = 0.0f;
+		for (int c = 0; c < m_channels; ++c)
+			sum += *input++;
+		tmpl[i] = sum;
+	}
+
+	//Energy of every candidate for normalization
+	if (m_energy.size() < count)
+		m_energy.resize(count);
+	double *energy = m_energy.data();
+	double e = 0.0;
+	for (int i = 0; i < m_hop; ++i)
+		e += mono[i] * mono[i];
+	energy[0] = e;
+	for (int i = 1; i < count; ++i)
+	{
+		e += mono[i + m_hop - 1] * mono[i + m_hop - 1] - mono[i - 1] * mono[i - 1];
+		energy[i] = qMax(0.0, e);
+	}
+
+	const auto score = [&](int i) {
+		return dotProduct(mono + i, tmpl, m_hop) / sqrt(energy[i] + 1e-9);
+	};
+
+	int best = qBound(0, (int)m_position - minPos, count - 1);
+	double bestScore = score(best);
+	for (int i = 0; i < count; i += m_coarseStep)
+	{
+		const double s = score(i);
+		if (s > bestScore)
+		{
+			bestScore = s;
+			best = i;
+		}
+	}
+	if (m_coarseStep > 1)
+	{
+		const int coarseBest = best;
+		const int refineLen = qMax(g_refineLen, m_coarseStep - 1);
+		for (int i = qMax(0, coarseBest - refineLen); i <= qMin(count - 1, coarseBest + refineLen); ++i)
+		{
+			const double s = score(i);
+			if (s > bestScore)
+			{
+				bestScore = s;
+				best = i;
+			}
+		}
+	}
+
+	return minPos + best;
+}
+void TimeStretch::overlapAdd(float *dst, int pos)
+{
+	const float *in1 = m_input.constData() + pos * m_channels;
+	const float *in2 = in1 + m_hop * m_channels;
+	float *overlap = m_overlap.data();
+	for (int i = 0; i < m_hop; ++i)
+	{
+		const float rise = m_rise[i];
+		const float fall = m_fall[i];
+		for (int c = 0; c < m_channels; ++c)
+		{
+			*dst++ = *overlap + *in1++ * rise;
+			*overlap++ = *in2++ * fall;
+		}
+	}
+}
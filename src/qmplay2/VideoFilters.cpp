@@ -18,10 +18,10 @@
 
 #include <VideoFilters.hpp>
 
+#include <ModulesRegistry.hpp>
 #include <DeintFilter.hpp>
 #include <VideoFrame.hpp>
 #include <TimeStamp.hpp>
-#include <Module.hpp>
 #include <CPU.hpp>
 
 extern "C"
@@ -29,6 +29,12 @@ extern "C"
 	#include <libavutil/cpu.h>
 }
 
+#if defined(QMPLAY2_CPU_X86)
+	#include <immintrin.h>
+#elif defined(QMPLAY2_CPU_ARM_NEON)
+	#include <arm_neon.h>
+#endif
+
 #ifdef QMPLAY2_CPU_X86
 #ifdef QMPLAY2_CPU_X86_32 //Every x86-64 CPU has SSE2, so MMXEXT is unused there
 static void averageTwoLines_MMXEXT(quint8 *dest, const quint8 *src1, const quint8 *src2, int linesize)
@@ -79,7 +85,46 @@ static void averageTwoLines_SSE2(quint8 *dest, const quint8 *src1, const quint8
 	while (dest < dest_end)
 		*dest++ = (*(src1++) + *(src2++)) >> 1;
 }
+__attribute__((target("avx2")))
+static void averageTwoLines_AVX2(quint8 *dest, const quint8 *src1, const quint8 *src2, int linesize)
+{
+	const int remaining = linesize % 32;
+	quint8 *dest_end = dest + linesize - remaining;
+	while (dest < dest_end)
+	{
+		const __m256i avg = _mm256_avg_epu8(_mm256_loadu_si256((const __m256i *)src1), _mm256_loadu_si256((const __m256i *)src2));
+		_mm256_storeu_si256((__m256i *)dest, avg);
+		dest += 32;
+		src1 += 32;
+		src2 += 32;
+	}
+	if (remaining >= 16)
+	{
+		averageTwoLines_SSE2(dest, src1, src2, remaining);
+		return;
+	}
+	dest_end += remaining;
+	while (dest < dest_end)
+		*dest++ = (*(src1++) + *(src2++)) >> 1;
+}
 #endif // QMPLAY2_CPU_X86
+#ifdef QMPLAY2_CPU_ARM_NEON
+static void averageTwoLines_NEON(quint8 *dest, const quint8 *src1, const quint8 *src2, int linesize)
+{
+	const int remaining = linesize % 16;
+	quint8 *dest_end = dest + linesize - remaining;
+	while (dest < dest_end)
+	{
+		vst1q_u8(dest, vrhaddq_u8(vld1q_u8(src1), vld1q_u8(src2))); //Rounds the same way as "pavgb"
+		dest += 16;
+		src1 += 16;
+		src2 += 16;
+	}
+	dest_end += remaining;
+	while (dest < dest_end)
+		*dest++ = (*(src1++) + *(src2++)) >> 1;
+}
+#endif // QMPLAY2_CPU_ARM_NEON
 static void averageTwoLines_C(quint8 *dest, const quint8 *src1, const quint8 *src2, int linesize)
 {
 	for (int i = 0; i < linesize; ++i)
@@ -140,117 +185,155 @@ private:
 
 /**/
 
-class VideoFiltersThr final : public QThread
+class VideoFiltersPipeline;
+
+class VideoFiltersStage final : public QThread
 {
 public:
-	VideoFiltersThr(VideoFilters &videoFilters) :
-		videoFilters(videoFilters)
+	VideoFiltersStage(VideoFiltersPipeline &pipeline, VideoFilter *filter, int idx) :
+		pipeline(pipeline),
+		filter(filter),
+		idx(idx)
 	{
-		setObjectName("VideoFiltersThr");
+		setObjectName("VideoFiltersStage");
 	}
-	~VideoFiltersThr()
+
+	QQueue<VideoFilter::FrameBuffer> input;
+	bool busy = false;
+	QWaitCondition cond;
+
+private:
+	void run() override;
+
+	VideoFiltersPipeline &pipeline;
+	VideoFilter *const filter;
+	const int idx;
+};
+
+/* Every filter runs in its own thread, frames are passed between stages using bounded queues */
+class VideoFiltersPipeline
+{
+public:
+	VideoFiltersPipeline(VideoFilters &videoFilters) :
+		videoFilters(videoFilters)
+	{}
+	~VideoFiltersPipeline()
 	{
 		stop();
 	}
 
-	void start()
+	void start(int queueDepth)
 	{
-		br = filtering = false;
-		QThread::start();
+		br = false;
+		this->queueDepth = qMax(1, queueDepth);
+		for (int i = 0; i < videoFilters.filters.count(); ++i)
+			stages.append(new VideoFiltersStage(*this, videoFilters.filters.at(i), i));
+		for (VideoFiltersStage *stage : asConst(stages))
+			stage->start();
 	}
 	void stop()
 	{
 		{
 			QMutexLocker locker(&mutex);
 			br = true;
-			cond.wakeOne();
+			for (VideoFiltersStage *stage : asConst(stages))
+				stage->cond.wakeOne();
+			cond.wakeAll();
 		}
-		wait();
+		for (VideoFiltersStage *stage : asConst(stages))
+			stage->wait();
+		qDeleteAll(stages);
+		stages.clear();
 	}
 
-	void filterFrame(const VideoFilter::FrameBuffer &frame)
+	/* Methods below must be called with locked "mutex" */
+
+	bool push(int idx, const VideoFilter::FrameBuffer &frame)
 	{
-		QMutexLocker locker(&mutex);
-		frameToFilter = frame;
-		filtering = true;
-		cond.wakeOne();
+		if (idx >= stages.count())
+		{
+			videoFilters.outputQueue.enqueue(frame);
+			cond.wakeAll();
+			return true;
+		}
+		VideoFiltersStage *stage = stages.at(idx);
+		while (stage->input.count() >= queueDepth && !br)
+			cond.wait(&mutex);
+		if (br)
+			return false;
+		stage->input.enqueue(frame);
+		stage->cond.wakeOne();
+		return true;
 	}
 
-	void waitForFinished(bool waitForAllFrames)
+	void waitForFinished(bool waitForAllFrames, bool untilCanAccept = false)
 	{
-		bufferMutex.lock();
-		while (filtering && !br)
+		while (!br && !isIdle())
 		{
 			if (!waitForAllFrames && !videoFilters.outputQueue.isEmpty())
 				break;
-			cond.wait(&bufferMutex);
+			if (untilCanAccept && stages.at(0)->input.count() < queueDepth)
+				break;
+			cond.wait(&mutex);
 		}
-		if (waitForAllFrames)
-			bufferMutex.unlock();
 	}
 
-	QMutex bufferMutex;
+	QWaitCondition cond;
+	QMutex mutex;
+	bool br = false;
+
 private:
-	void run() override
+	bool isIdle() const
 	{
-		while (!br)
-		{
-			QMutexLocker locker(&mutex);
-
-			if (frameToFilter.frame.isEmpty() && !br)
-				cond.wait(&mutex);
-			if (frameToFilter.frame.isEmpty() || br)
-				continue;
+		for (const VideoFiltersStage *stage : stages)
+			if (stage->busy || !stage->input.isEmpty())
+				return false;
+		return true;
+	}
 
-			QQueue<VideoFilter::FrameBuffer> queue;
-			queue.enqueue(frameToFilter);
-			frameToFilter.frame.clear();
+	VideoFilters &videoFilters;
+	QVector<VideoFiltersStage *> stages;
+	int queueDepth = 1;
+};
 
-			bool pending = false;
-			do
-			{
-				for (VideoFilter *vFilter : asConst(videoFilters.filters))
-				{
-					pending |= vFilter->filter(queue);
-					if (queue.isEmpty())
-					{
-						pending = false;
-						break;
-					}
-				}
-
-				{
-					QMutexLocker locker(&bufferMutex);
-					if (!queue.isEmpty())
-					{
-						videoFilters.outputQueue.append(queue);
-						videoFilters.outputNotEmpty = true;
-						queue.clear();
-					}
-					if (!pending)
-						filtering = false;
-				}
-
-				cond.wakeOne();
-			} while (pending && !br);
-		}
-		if (br)
+void VideoFiltersStage::run()
+{
+	QMutexLocker locker(&pipeline.mutex);
+	while (!pipeline.br)
+	{
+		if (input.isEmpty())
 		{
-			QMutexLocker locker(&bufferMutex);
-			filtering = false;
-			cond.wakeOne();
+			cond.wait(&pipeline.mutex);
+			continue;
 		}
-	}
 
-	VideoFilters &videoFilters;
+		QQueue<VideoFilter::FrameBuffer> queue;
+		queue.enqueue(input.dequeue());
+		busy = true;
+		pipeline.cond.wakeAll(); // There is a space in the input queue
 
-	bool br = false, filtering = false;
+		for (;;)
+		{
+			locker.unlock();
+			const bool pending = filter->filter(queue);
+			locker.relock();
 
-	QWaitCondition cond;
-	QMutex mutex;
+			if (queue.isEmpty())
+				break;
+			while (!queue.isEmpty())
+			{
+				if (!pipeline.push(idx + 1, queue.dequeue()))
+					break;
+			}
 
-	VideoFilter::FrameBuffer frameToFilter;
-};
+			if (!pending || pipeline.br)
+				break;
+		}
+
+		busy = false;
+		pipeline.cond.wakeAll();
+	}
+}
 
 /**/
 
@@ -259,35 +342,38 @@ void VideoFilters::init()
 	averageTwoLinesPtr = averageTwoLines_C;
 #ifdef QMPLAY2_CPU_X86
 	const int cpuFlags = av_get_cpu_flags();
-	if (cpuFlags & AV_CPU_FLAG_SSE2)
+	if (cpuFlags & AV_CPU_FLAG_AVX2)
+		averageTwoLinesPtr = averageTwoLines_AVX2;
+	else if (cpuFlags & AV_CPU_FLAG_SSE2)
 		averageTwoLinesPtr = averageTwoLines_SSE2;
 #ifdef QMPLAY2_CPU_X86_32
 	else if (cpuFlags & AV_CPU_FLAG_MMXEXT)
 		averageTwoLinesPtr = averageTwoLines_MMXEXT;
 #endif // QMPLAY2_CPU_X86_32
+#elif defined(QMPLAY2_CPU_ARM_NEON)
+	averageTwoLinesPtr = averageTwoLines_NEON;
 #endif // QMPLAY2_CPU_X86
 }
 
 VideoFilters::VideoFilters() :
-	filtersThr(*(new VideoFiltersThr(*this))),
-	outputNotEmpty(false)
+	pipeline(*(new VideoFiltersPipeline(*this)))
 {}
 VideoFilters::~VideoFilters()
 {
 	clear();
-	delete &filtersThr;
+	delete &pipeline;
 }
 
-void VideoFilters::start()
+void VideoFilters::start(int queueDepth)
 {
 	if (!filters.isEmpty())
-		filtersThr.start();
+		pipeline.start(queueDepth);
 }
 void VideoFilters::clear()
 {
 	if (!filters.isEmpty())
 	{
-		filtersThr.stop();
+		pipeline.stop();
 		for (VideoFilter *vFilter : asConst(filters))
 			delete vFilter;
 		filters.clear();
@@ -300,13 +386,12 @@ VideoFilter *VideoFilters::on(const QString &filterName)
 	VideoFilter *filter = nullptr;
 	if (filterName == "PrepareForHWBobDeint")
 		filter = new PrepareForHWBobDeint;
-	else for (Module *module : QMPlay2Core.getPluginsInstance())
-		for (const Module::Info &mod : module->getModulesInfo())
-			if ((mod.type & 0xF) == Module::VIDEOFILTER && mod.name == filterName)
-			{
-				filter = (VideoFilter *)module->createInstance(mod.name);
-				break;
-			}
+	else
+	{
+		const auto modulesRegistry = ModulesRegistry::get();
+		if (const ModulesRegistry::Item *item = modulesRegistry->find(Module::VIDEOFILTER, filterName))
+			filter = (VideoFilter *)item->module->createInstance(item->info.name);
+	}
 	if (filter)
 		filters.append(filter);
 	return filter;
@@ -324,20 +409,22 @@ void VideoFilters::off(VideoFilter *&videoFilter)
 
 void VideoFilters::clearBuffers()
 {
+	QMutexLocker locker(&pipeline.mutex);
 	if (!filters.isEmpty())
 	{
-		filtersThr.waitForFinished(true);
+		pipeline.waitForFinished(true);
 		for (VideoFilter *vFilter : asConst(filters))
 			vFilter->clearBuffer();
 	}
 	outputQueue.clear();
-	outputNotEmpty = false;
+	frameAdded = false;
 }
 void VideoFilters::removeLastFromInputBuffer()
 {
 	if (!filters.isEmpty())
 	{
-		filtersThr.waitForFinished(true);
+		QMutexLocker locker(&pipeline.mutex);
+		pipeline.waitForFinished(true);
 		for (int i = filters.count() - 1; i >= 0; --i)
 			if (filters[i]->removeLastFromInternalBuffer())
 				break;
@@ -347,35 +434,39 @@ void VideoFilters::removeLastFromInputBuffer()
 void VideoFilters::addFrame(const VideoFrame &videoFrame, double ts)
 {
 	const VideoFilter::FrameBuffer frame(videoFrame, ts);
+	QMutexLocker locker(&pipeline.mutex);
 	if (!filters.isEmpty())
-		filtersThr.filterFrame(frame);
+	{
+		pipeline.push(0, frame);
+		frameAdded = true;
+	}
 	else
 	{
 		outputQueue.enqueue(frame);
-		outputNotEmpty = true;
 	}
 }
 bool VideoFilters::getFrame(VideoFrame &videoFrame, TimeStamp &ts)
 {
-	bool locked, ret;
-	if ((locked = !filters.isEmpty()))
-		filtersThr.waitForFinished(false);
-	if ((ret = !outputQueue.isEmpty()))
+	QMutexLocker locker(&pipeline.mutex);
+	if (!filters.isEmpty())
 	{
-		videoFrame = outputQueue.at(0).frame;
-		ts = outputQueue.at(0).ts;
-		outputQueue.removeFirst();
-		outputNotEmpty = !outputQueue.isEmpty();
+		// Don't wait for the frame which has just been added if the pipeline can accept next one,
+		// otherwise (e.g. on flush) wait for filtered frames.
+		pipeline.waitForFinished(false, frameAdded);
+		frameAdded = false;
 	}
-	if (locked)
-		filtersThr.bufferMutex.unlock();
-	return ret;
+	if (outputQueue.isEmpty())
+		return false;
+	const VideoFilter::FrameBuffer frame = outputQueue.dequeue();
+	videoFrame = frame.frame;
+	ts = frame.ts;
+	return true;
 }
 
 bool VideoFilters::readyRead()
 {
-	filtersThr.waitForFinished(false);
-	const bool ret = outputNotEmpty;
-	filtersThr.bufferMutex.unlock();
-	return ret;
+	QMutexLocker locker(&pipeline.mutex);
+	if (!filters.isEmpty())
+		pipeline.waitForFinished(false, true);
+	return !outputQueue.isEmpty();
 }
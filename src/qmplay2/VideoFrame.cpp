@@ -18,9 +18,50 @@
 
 #include <VideoFrame.hpp>
 
+#include <QMutex>
+#include <QVector>
+#include <QPair>
+
 extern "C"
 {
 	#include <libavutil/common.h>
+	#include <libavutil/buffer.h>
+}
+
+/* Pools of plane buffers, so filters and decoders don't allocate new memory for every frame */
+
+constexpr int g_maxPools = 12; //3 planes for a few different frame sizes
+
+static QMutex g_poolsMutex;
+static QVector<QPair<qint32, AVBufferPool *>> g_pools; //Recently used pool is the first
+
+static AVBufferRef *getPooledBuffer(qint32 size)
+{
+	QMutexLocker locker(&g_poolsMutex);
+
+	int idx = 0;
+	while (idx < g_pools.count() && g_pools.at(idx).first != size)
+		++idx;
+
+	if (idx == g_pools.count())
+	{
+		AVBufferPool *pool = av_buffer_pool_init(size, nullptr);
+		if (!pool)
+			return nullptr;
+		g_pools.prepend({size, pool});
+		if (g_pools.count() > g_maxPools)
+		{
+			// Pool is freed when all its buffers are released
+			av_buffer_pool_uninit(&g_pools.last().second);
+			g_pools.removeLast();
+		}
+	}
+	else if (idx > 0)
+	{
+		g_pools.move(idx, 0);
+	}
+
+	return av_buffer_pool_get(g_pools.first().second);
 }
 
 qint32 VideoFrameSize::chromaWidth() const
@@ -58,7 +99,7 @@ void VideoFrameSize::clear()
 
 /**/
 
-VideoFrame::VideoFrame(const VideoFrameSize &size, AVBufferRef *bufferRef[], const qint32 newLinesize[], bool interlaced, bool tff) :
+VideoFrame::VideoFrame(const VideoFrameSize &size, AVBufferRef *bufferRef[], const qint32 newLinesize[], bool interlaced, bool tff, const qint32 offset[]) :
 	size(size),
 	interlaced(interlaced),
 	tff(tff),
@@ -67,7 +108,7 @@ VideoFrame::VideoFrame(const VideoFrameSize &size, AVBufferRef *bufferRef[], con
 	for (qint32 p = 0; p < 3 && bufferRef[p]; ++p)
 	{
 		linesize[p] = newLinesize[p];
-		buffer[p].assign(bufferRef[p], linesize[p] * size.getHeight(p));
+		buffer[p].assign(bufferRef[p], linesize[p] * size.getHeight(p), offset ? offset[p] : 0);
 		bufferRef[p] = nullptr;
 	}
 }
@@ -80,7 +121,11 @@ VideoFrame::VideoFrame(const VideoFrameSize &size, const qint32 newLinesize[], b
 	for (qint32 p = 0; p < 3; ++p)
 	{
 		linesize[p] = newLinesize[p];
-		buffer[p].resize(linesize[p] * size.getHeight(p));
+		const qint32 planeSize = linesize[p] * size.getHeight(p);
+		if (AVBufferRef *bufferRef = getPooledBuffer(planeSize))
+			buffer[p].assign(bufferRef, planeSize);
+		else
+			buffer[p].resize(planeSize);
 	}
 }
 VideoFrame::VideoFrame(const VideoFrameSize &size, quintptr surfaceId, bool interlaced, bool tff) :
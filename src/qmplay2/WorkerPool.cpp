@@ -0,0 +1,170 @@
+/*
+	QMPlay2 is a video and audio player.
+	Copyright (C) 2010-2018  Błażej Szczygieł
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU Lesser General Public License as published
+	by the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <WorkerPool.hpp>
+
+#include <QThread>
+
+#include <atomic>
+
+struct WorkerPool::Task
+{
+	inline Task(int jobsCount, const std::function<void(int)> &fn) :
+		fn(fn),
+		jobsCount(jobsCount)
+	{}
+
+	const std::function<void(int)> &fn;
+	const int jobsCount;
+	std::atomic_int nextJob {0};
+	int jobsDone = 0; //Guarded by "m_mutex"
+	int users = 0; //Threads which are executing jobs of this task, guarded by "m_mutex"
+};
+
+class WorkerPoolThr final : public QThread
+{
+public:
+	WorkerPoolThr(WorkerPool &pool) :
+		pool(pool)
+	{
+		setObjectName("WorkerPoolThr");
+	}
+
+private:
+	void run() override
+	{
+		QMutexLocker locker(&pool.m_mutex);
+		while (!pool.m_br)
+		{
+			if (pool.m_tasks.isEmpty())
+			{
+				pool.m_taskCond.wait(&pool.m_mutex);
+				continue;
+			}
+			WorkerPool::Task *task = pool.m_tasks.first();
+			++task->users;
+			locker.unlock();
+			pool.runJobs(task);
+			locker.relock();
+		}
+	}
+
+	WorkerPool &pool;
+};
+
+/**/
+
+WorkerPool &WorkerPool::instance()
+{
+	static WorkerPool workerPool;
+	return workerPool;
+}
+
+WorkerPool::WorkerPool()
+{}
+WorkerPool::~WorkerPool()
+{
+	stop();
+}
+
+int WorkerPool::threadsCount() const
+{
+	return qMax(1, QThread::idealThreadCount());
+}
+
+void WorkerPool::run(int jobsCount, const std::function<void(int)> &fn)
+{
+	if (jobsCount <= 0)
+		return;
+	if (jobsCount == 1 || threadsCount() == 1)
+	{
+		for (int jobId = 0; jobId < jobsCount; ++jobId)
+			fn(jobId);
+		return;
+	}
+
+	Task task(jobsCount, fn);
+	task.users = 1;
+
+	m_mutex.lock();
+	if (m_threads.isEmpty())
+		startThreads();
+	m_tasks.append(&task);
+	m_taskCond.wakeAll();
+	m_mutex.unlock();
+
+	runJobs(&task);
+
+	QMutexLocker locker(&m_mutex);
+	while (task.jobsDone < task.jobsCount || task.users > 0)
+		m_doneCond.wait(&m_mutex);
+}
+void WorkerPool::parallelFor(int count, int grain, const std::function<void(int, int)> &fn)
+{
+	grain = qMax(1, grain);
+	const int jobsCount = (count + grain - 1) / grain;
+	run(jobsCount, [&](int jobId) {
+		const int begin = jobId * grain;
+		fn(begin, qMin(begin + grain, count));
+	});
+}
+
+void WorkerPool::stop()
+{
+	{
+		QMutexLocker locker(&m_mutex);
+		m_br = true;
+		m_taskCond.wakeAll();
+	}
+	for (WorkerPoolThr *thr : m_threads)
+		thr->wait();
+	qDeleteAll(m_threads);
+	m_threads.clear();
+	m_br = false;
+}
+
+void WorkerPool::startThreads()
+{
+	const int count = threadsCount() - 1;
+	for (int i = 0; i < count; ++i)
+	{
+		WorkerPoolThr *thr = new WorkerPoolThr(*this);
+		thr->start();
+		m_threads.append(thr);
+	}
+}
+
+void WorkerPool::runJobs(Task *task)
+{
+	// "task->users" must be already incremented, so the task can't be destroyed here
+	int jobsDone = 0;
+	for (;;)
+	{
+		const int jobId = task->nextJob.fetch_add(1);
+		if (jobId >= task->jobsCount)
+			break;
+		task->fn(jobId);
+		++jobsDone;
+	}
+
+	QMutexLocker locker(&m_mutex);
+	m_tasks.removeOne(task); //All jobs are taken, don't give this task to other workers
+	task->jobsDone += jobsDone;
+	if (--task->users == 0 && task->jobsDone == task->jobsCount)
+		m_doneCond.wakeAll();
+}
@@ -18,6 +18,7 @@
 
 #include <Writer.hpp>
 
+#include <ModulesRegistry.hpp>
 #include <Functions.hpp>
 
 #include <QBuffer>
@@ -110,27 +111,26 @@ Writer *Writer::create(const QString &url, const QStringList &modNames)
 			return nullptr;
 		}
 	}
-	QVector<QPair<Module *, Module::Info>> pluginsInstances(modNames.count());
-	for (Module *pluginInstance : QMPlay2Core.getPluginsInstance())
-		for (const Module::Info &mod : pluginInstance->getModulesInfo())
-			if (mod.type == Module::WRITER && mod.extensions.contains(scheme))
+	const auto modulesRegistry = ModulesRegistry::get();
+	ModulesRegistry::ItemPtrs pluginsInstances(modNames.count());
+	for (const ModulesRegistry::Item *item : modulesRegistry->find(Module::WRITER, QString(), scheme))
+		if (item->info.type == Module::WRITER)
+		{
+			if (modNames.isEmpty())
+				pluginsInstances += item;
+			else
 			{
-				if (modNames.isEmpty())
-					pluginsInstances += {pluginInstance, mod};
-				else
-				{
-					const int idx = modNames.indexOf(mod.name);
-					if (idx > -1)
-						pluginsInstances[idx] = {pluginInstance, mod};
-				}
+				const int idx = modNames.indexOf(item->info.name);
+				if (idx > -1)
+					pluginsInstances[idx] = item;
 			}
+		}
 	for (int i = 0; i < pluginsInstances.count(); i++)
 	{
-		Module *module = pluginsInstances[i].first;
-		Module::Info &moduleInfo = pluginsInstances[i].second;
-		if (!module || moduleInfo.name.isEmpty())
+		const ModulesRegistry::Item *item = pluginsInstances.at(i);
+		if (!item || item->info.name.isEmpty())
 			continue;
-		writer = (Writer *)module->createInstance(moduleInfo.name);
+		writer = (Writer *)item->module->createInstance(item->info.name);
 		if (!writer)
 			continue;
 		writer->_url = url;
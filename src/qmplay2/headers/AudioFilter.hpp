@@ -21,9 +21,60 @@
 #include <ModuleCommon.hpp>
 
 #include <QVector>
+#include <QMutex>
+
+#include <atomic>
 
 class Buffer;
 
+/*
+ * Lock-free parameters for audio filters (triple buffering). The GUI thread publishes
+ * a new snapshot in "set()" and "filter()" takes the newest one without ever waiting,
+ * so changing settings can't cause underruns. Old snapshots are overwritten (and their
+ * memory is freed) only by the publishing thread.
+ */
+template<typename T>
+class AudioFilterParams
+{
+	Q_DISABLE_COPY(AudioFilterParams)
+
+public:
+	AudioFilterParams() = default;
+
+	//Any thread except the one which calls "filter()"
+	void publish(const T &params)
+	{
+		QMutexLocker locker(&m_publishMutex);
+		m_slots[m_back] = params;
+		m_back = m_state.exchange(m_back | NewFlag) & IndexMask;
+	}
+
+	//Only the thread which calls "filter()", returns true if a new snapshot has been taken
+	bool update()
+	{
+		if (!(m_state.load() & NewFlag))
+			return false;
+		m_front = m_state.exchange(m_front) & IndexMask;
+		return true;
+	}
+	inline const T &get() const
+	{
+		return m_slots[m_front];
+	}
+
+private:
+	enum
+	{
+		IndexMask = 0x3,
+		NewFlag = 0x4
+	};
+
+	T m_slots[3];
+	int m_front = 0, m_back = 1;
+	std::atomic_int m_state {2};
+	QMutex m_publishMutex;
+};
+
 class QMPLAY2SHAREDLIB_EXPORT AudioFilter : public ModuleCommon
 {
 public:
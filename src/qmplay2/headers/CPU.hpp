@@ -25,3 +25,7 @@
 	#define QMPLAY2_CPU_X86_64
 	#define QMPLAY2_CPU_X86
 #endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#define QMPLAY2_CPU_ARM_NEON
+#endif
@@ -23,6 +23,8 @@
 #include <QByteArray>
 #include <QList>
 
+#include <atomic>
+
 class Settings;
 class QMPlay2OSD;
 struct ass_style;
@@ -64,10 +66,18 @@ public:
 	void flushASSEvents();
 	bool getASS(QMPlay2OSD *&, double);
 	void closeASS();
+
+	//Changes whenever subtitles rendered by "getASS()" can look differently for the same time stamp
+	inline quint32 revision() const
+	{
+		return m_revision;
+	}
 private:
 	void readStyle(const QString &, ass_style *);
 	inline void calcSize();
 
+	void eventsAdded(int firstEvent);
+
 	Settings &settings;
 
 	ass_library *ass;
@@ -85,4 +95,9 @@ private:
 	ass_renderer *ass_sub_renderer;
 	QList<ass_style *> ass_sub_styles_copy;
 	bool hasASSData, overridePlayRes;
+
+	std::atomic<quint32> m_revision {0};
+	//Time range (ms) rendered by "getASS()" since "m_renderedRevision", new events outside don't change the revision
+	qint64 m_renderedFrom = 0, m_renderedTo = -1;
+	quint32 m_renderedRevision = 0;
 };
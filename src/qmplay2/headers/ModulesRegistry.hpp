@@ -0,0 +1,81 @@
+/*
+	QMPlay2 is a video and audio player.
+	Copyright (C) 2010-2018  Błażej Szczygieł
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU Lesser General Public License as published
+	by the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <Module.hpp>
+
+#include <QVector>
+#include <QHash>
+
+#include <memory>
+
+/*
+ * Cached "Module::getModulesInfo()" of all loaded modules, indexed by type, name and extension.
+ *
+ * "getModulesInfo()" builds a new list and reads settings on every call, so it's too expensive
+ * for creating an instance per file. The registry is built once and shared, it's rebuilt on the
+ * next use after any settings change (modules can be enabled or disabled in settings).
+ */
+class QMPLAY2SHAREDLIB_EXPORT ModulesRegistry
+{
+	Q_DISABLE_COPY(ModulesRegistry)
+
+public:
+	struct Item
+	{
+		Module *module;
+		Module::Info info;
+	};
+	using Items = QVector<Item>;
+	using ItemPtrs = QVector<const Item *>;
+
+	//Thread-safe, returned registry is immutable and valid until modules are unloaded
+	static std::shared_ptr<const ModulesRegistry> get();
+	static void invalidate(); //Cheap, called on every settings change
+	static void reset(); //Drops the cached registry, used when modules are loaded or unloaded
+
+	//All modules of the type ("Module::TYPE" without flags) in the modules order
+	const Items &items(quint32 type) const;
+
+	//The first module of the type named "name" or "nullptr"
+	const Item *find(quint32 type, const QString &name) const;
+	//Modules of the type named "name" or supporting "extension" in the modules order
+	ItemPtrs find(quint32 type, const QString &name, const QString &extension) const;
+	//Modules of the type named "name" or without any extensions in the modules order
+	ItemPtrs findWithoutExtensions(quint32 type, const QString &name) const;
+
+	QStringList extensions(quint32 type) const;
+
+private:
+	ModulesRegistry(int version);
+
+	struct TypeIndex;
+	static ItemPtrs merge(const TypeIndex &typeIndex, int nameIdx, const QVector<int> &idxs);
+
+	struct TypeIndex
+	{
+		Items items;
+		QHash<QString, int> byName;
+		QHash<QString, QVector<int>> byExtension;
+		QVector<int> withoutExtensions;
+	};
+
+	const int m_version;
+	QVector<TypeIndex> m_types;
+};
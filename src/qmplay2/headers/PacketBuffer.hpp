@@ -20,29 +20,75 @@
 
 #include <Packet.hpp>
 
+#include <QVector>
 #include <QMutex>
-#include <QList>
 
-class QMPLAY2SHAREDLIB_EXPORT PacketBuffer : private QList<Packet>
+#include <atomic>
+
+/*
+ * Preallocated ring buffer of packets with one producer (demuxer) and one consumer (A/V thread).
+ *
+ * "canFetch()", "remainingPacketsCount()" and "fetch()" are lock-free and can be used by the
+ * consumer without locking. Everything else must be called with the buffer locked - it is
+ * uncontended, because the consumer never takes the lock.
+ *
+ * Packets are addressed by monotonic 64-bit indices, the ring index is "index & mask".
+ * Durations and sizes are stored as prefix sums, so the consumer doesn't have to update any
+ * counters and the remaining/backward values are always derived from "m_first", "m_pos" and "m_end".
+ *
+ * Seeking in buffer uses binary search on running maximum of timestamps and on the key frames index.
+ */
+class QMPLAY2SHAREDLIB_EXPORT PacketBuffer
 {
 	static int backwardPackets;
+
+	struct Slot
+	{
+		Packet packet;
+		double durationBefore = 0.0;
+		qint64 bytesBefore = 0;
+		double maxTs = 0.0; //Highest timestamp up to this packet, it is monotonic so it can be binary searched
+	};
+	struct Ring
+	{
+		inline Ring(int capacity) :
+			slots(capacity),
+			mask(capacity - 1)
+		{}
+
+		inline Slot &at(quint64 idx)
+		{
+			return slots[idx & mask];
+		}
+		inline const Slot &at(quint64 idx) const
+		{
+			return slots.at(idx & mask);
+		}
+
+		QVector<Slot> slots;
+		const quint64 mask;
+	};
+
 public:
 	static void setBackwardPackets(int backwardPackets)
 	{
 		PacketBuffer::backwardPackets = backwardPackets;
 	}
 
+	PacketBuffer();
+	~PacketBuffer();
+
 	bool seekTo(double seekPos, bool backward);
 	void clear(); //Thread-safe
 
 	void put(const Packet &packet); //Thread-safe
-	Packet fetch();
+	bool fetch(Packet &packet); //Lock-free, consumer only
 
 	void clearBackwards();
 
 	inline bool isEmpty() const
 	{
-		return QList<Packet>::isEmpty();
+		return packetsCount() == 0;
 	}
 
 	inline bool canFetch() const
@@ -51,43 +97,31 @@ public:
 	}
 	inline int remainingPacketsCount() const
 	{
-		return packetsCount() - m_pos;
+		return m_end.load() - m_pos.load();
 	}
 	inline int packetsCount() const
 	{
-		return count();
+		return m_end.load() - m_first;
 	}
 
 	inline double firstPacketTime() const
 	{
-		return begin()->ts;
+		return ring()->at(m_first).packet.ts;
 	}
 	inline double currentPacketTime() const
 	{
-		return at(m_pos).ts;
+		return ring()->at(m_pos.load()).packet.ts;
 	}
 	inline double lastPacketTime() const
 	{
-		return (--end())->ts;
+		return ring()->at(m_end.load() - 1).packet.ts;
 	}
 
-	inline double remainingDuration() const
-	{
-		return m_remainingDuration;
-	}
-	inline double backwardDuration() const
-	{
-		return m_backwardDuration;
-	}
+	double remainingDuration() const;
+	double backwardDuration() const;
 
-	inline qint64 remainingBytes() const
-	{
-		return m_remainingBytes;
-	}
-	inline qint64 backwardBytes() const
-	{
-		return m_backwardBytes;
-	}
+	qint64 remainingBytes() const;
+	qint64 backwardBytes() const;
 
 	inline void lock()
 	{
@@ -97,9 +131,44 @@ public:
 	{
 		m_mutex.unlock();
 	}
+
 private:
-	double m_remainingDuration = 0.0, m_backwardDuration = 0.0;
-	qint64 m_remainingBytes = 0, m_backwardBytes = 0;
+	inline Ring *ring() const
+	{
+		return m_ring.load();
+	}
+
+	inline double durationBefore(quint64 idx) const;
+	inline qint64 bytesBefore(quint64 idx) const;
+
+	quint64 safePos() const;
+	void waitForConsumer(quint64 idx) const;
+	void dropUntil(quint64 idx);
+
+	inline quint64 keyFrameAt(quint64 kIdx) const
+	{
+		return m_keyFrames.at(kIdx & (m_keyFrames.count() - 1));
+	}
+	void addKeyFrame(quint64 idx);
+	bool findKeyFrame(quint64 &idx, double seekTs, bool forward) const;
+
+	void grow();
+	void releaseRetired();
+
+	std::atomic<Ring *> m_ring;
+	QVector<Ring *> m_retired;
+
+	quint64 m_first = 0; //Oldest packet, modified only by producer
+	std::atomic<quint64> m_pos; //Next packet to fetch
+	std::atomic<quint64> m_end; //Next free slot, modified only by producer
+	std::atomic<quint64> m_reading; //Index which is currently read by consumer
+
+	double m_durationSum = 0.0;
+	qint64 m_bytesSum = 0;
+	double m_maxTs = -qInf();
+
+	QVector<quint64> m_keyFrames; //Ring of packet indices, modified only by producer
+	quint64 m_keyFramesFirst = 0, m_keyFramesEnd = 0;
+
 	QMutex m_mutex;
-	int m_pos = 0;
 };
@@ -78,6 +78,8 @@ public:
 
 	void genId();
 
+	void copyImages(const QMPlay2OSD &other); //Copies images and ID, images data is shared
+
 	void clear(bool all = true);
 
 	inline void lock() const
@@ -0,0 +1,52 @@
+/*
+	QMPlay2 is a video and audio player.
+	Copyright (C) 2010-2018  Błażej Szczygieł
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU Lesser General Public License as published
+	by the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QMPlay2Lib.hpp>
+
+/*
+ * Conversion of integer and double audio samples to float, optimized at runtime for
+ * SSE2, AVX2 or NEON. Packed conversions can be done in-place ("dst" equal to "src").
+ * There is also an in-place gain stage for interleaved float samples.
+ */
+namespace SampleConvert
+{
+	constexpr int maxChannels = 255; //Channel count is stored as "quint8"
+
+	enum Format
+	{
+		U8,
+		S16,
+		S32,
+		FLT,
+		DBL
+	};
+
+	QMPLAY2SHAREDLIB_EXPORT void u8ToFloat(float *dst, const quint8 *src, int count);
+	QMPLAY2SHAREDLIB_EXPORT void s8ToFloat(float *dst, const qint8 *src, int count);
+	QMPLAY2SHAREDLIB_EXPORT void s16ToFloat(float *dst, const qint16 *src, int count, float scale = 1.0f / 32768.0f);
+	QMPLAY2SHAREDLIB_EXPORT void s32ToFloat(float *dst, const qint32 *src, int count, float scale = 1.0f / 2147483648.0f);
+	QMPLAY2SHAREDLIB_EXPORT void dblToFloat(float *dst, const double *src, int count);
+
+	//Converts and interleaves "channels" planes of "samples" samples each
+	QMPLAY2SHAREDLIB_EXPORT void planarToFloat(Format fmt, float *dst, const void *const *src, int channels, int samples);
+
+	//Multiplies every channel by its gain and by linear fade ("fade - frame * fadeStep" limited to 0.0 - 1.0), clips to -1.0 - 1.0
+	QMPLAY2SHAREDLIB_EXPORT void applyGain(float *data, int frames, int channels, const float *gains, float fade = 1.0f, float fadeStep = 0.0f);
+}
@@ -21,6 +21,7 @@
 #include <QMPlay2Lib.hpp>
 
 class QByteArray;
+class Buffer;
 
 class QMPLAY2SHAREDLIB_EXPORT SndResampler
 {
@@ -39,9 +40,14 @@ public:
 	}
 
 	bool create(int _src_samplerate, int _src_channels, int _dst_samplerate, int _dst_channels);
-	void convert(const QByteArray &src, QByteArray &dst);
+	//"dst" is owned by the caller and should be kept between calls, so its memory is reused
+	void convert(const QByteArray &src, Buffer &dst);
+	//Drains samples delayed inside the resampler, then the resampler can be used again
+	void flush(Buffer &dst);
 	void destroy();
 private:
+	void convert(const quint8 *in, int in_size, int out_size, Buffer &dst);
+
 #ifdef QMPLAY2_AVRESAMPLE
 	struct AVAudioResampleContext *snd_convert_ctx = nullptr;
 #else
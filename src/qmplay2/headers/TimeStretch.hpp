@@ -0,0 +1,86 @@
+/*
+	QMPlay2 is a video and audio player.
+	Copyright (C) 2010-2018  Błażej Szczygieł
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU Lesser General Public License as published
+	by the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QMPlay2Lib.hpp>
+
+#include <QVector>
+
+class Buffer;
+
+/*
+ * Changes playback speed without changing the pitch (WSOLA - waveform similarity overlap-add).
+ *
+ * Output is built from Hann windowed segments of input overlapped by half. Every next segment
+ * is taken near its nominal position ("speed" times further in input than in output) where it
+ * is the most similar to the natural continuation of the previous segment. Similarity is
+ * computed on a mono mix of the channels, so the cost doesn't depend much on channels count.
+ */
+class QMPLAY2SHAREDLIB_EXPORT TimeStretch
+{
+	Q_DISABLE_COPY(TimeStretch)
+
+public:
+	TimeStretch() = default;
+
+	void setParams(int channels, int sampleRate);
+	void setSpeed(double speed);
+
+	//"process()" must be used also after going back to 1.0x, until remaining samples are written
+	inline bool isActive() const
+	{
+		return m_channels > 0 && (m_speed != 1.0 || m_started);
+	}
+
+	double delay() const; //Input audio waiting for processing in seconds
+
+	void clear();
+
+	//Interleaved float samples, "dst" is owned by the caller and should be kept between calls
+	void process(const float *src, int frames, Buffer &dst);
+	//Writes the remaining input at the end of stream and clears
+	void flush(Buffer &dst);
+
+private:
+	void appendInput(const float *src, int frames);
+	void discardInput(int frames);
+
+	int findBestPosition(int minPos, int maxPos);
+	void overlapAdd(float *dst, int pos);
+
+	int m_channels = 0, m_sampleRate = 0;
+	double m_speed = 1.0;
+
+	int m_hop = 0;        //Half of the window, output frames per segment
+	int m_seek = 0;       //Maximum distance from the nominal position
+	int m_coarseStep = 1; //Step of the first pass of the search
+
+	QVector<float> m_rise, m_fall;
+
+	QVector<float> m_input;
+	int m_inputFrames = 0;
+
+	bool m_started = false;
+	int m_prevPos = 0;       //Position of the previous segment in "m_input"
+	double m_position = 0.0; //Nominal position of the next segment in "m_input"
+	QVector<float> m_overlap; //Falling half of the previous segment
+
+	QVector<float> m_mono, m_template;
+	QVector<double> m_energy;
+};
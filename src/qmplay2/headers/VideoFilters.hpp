@@ -26,13 +26,13 @@
 #include <QMutex>
 #include <QQueue>
 
-class VideoFiltersThr;
+class VideoFiltersPipeline;
 class TimeStamp;
 
 class QMPLAY2SHAREDLIB_EXPORT VideoFilters
 {
 	Q_DISABLE_COPY(VideoFilters)
-	friend class VideoFiltersThr;
+	friend class VideoFiltersPipeline;
 public:
 	static void init();
 
@@ -44,7 +44,7 @@ public:
 	VideoFilters();
 	~VideoFilters();
 
-	void start();
+	void start(int queueDepth = 1);
 	void clear();
 
 	VideoFilter *on(const QString &filterName);
@@ -62,6 +62,6 @@ private:
 
 	QQueue<VideoFilter::FrameBuffer> outputQueue;
 	QVector<VideoFilter *> filters;
-	VideoFiltersThr &filtersThr;
-	bool outputNotEmpty = false;
+	VideoFiltersPipeline &pipeline;
+	bool frameAdded = false;
 };
@@ -59,7 +59,7 @@ public:
 class QMPLAY2SHAREDLIB_EXPORT VideoFrame
 {
 public:
-	VideoFrame(const VideoFrameSize &size, AVBufferRef *bufferRef[], const qint32 newLinesize[], bool interlaced, bool tff);
+	VideoFrame(const VideoFrameSize &size, AVBufferRef *bufferRef[], const qint32 newLinesize[], bool interlaced, bool tff, const qint32 offset[] = nullptr);
 	VideoFrame(const VideoFrameSize &size, const qint32 newLinesize[], bool interlaced = false, bool tff = false);
 	VideoFrame(const VideoFrameSize &size, quintptr surfaceId, bool interlaced, bool tff);
 	VideoFrame();
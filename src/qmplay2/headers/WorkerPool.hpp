@@ -0,0 +1,69 @@
+/*
+	QMPlay2 is a video and audio player.
+	Copyright (C) 2010-2018  Błażej Szczygieł
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU Lesser General Public License as published
+	by the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU Lesser General Public License for more details.
+
+	You should have received a copy of the GNU Lesser General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <QMPlay2Lib.hpp>
+
+#include <QWaitCondition>
+#include <QVector>
+#include <QMutex>
+
+#include <functional>
+
+class WorkerPoolThr;
+
+/*
+ * Shared pool of worker threads for data parallel filters (deinterlacers, scalers, etc.).
+ *
+ * Every "run()" call is split into small jobs which are taken dynamically by idle workers
+ * and by the calling thread, so uneven cost of jobs doesn't leave threads idle and nested
+ * or concurrent calls from different threads can't deadlock.
+ */
+class QMPLAY2SHAREDLIB_EXPORT WorkerPool
+{
+	Q_DISABLE_COPY(WorkerPool)
+	friend class WorkerPoolThr;
+
+	struct Task;
+
+public:
+	static WorkerPool &instance();
+
+	int threadsCount() const; //Including the calling thread
+
+	void run(int jobsCount, const std::function<void(int jobId)> &fn);
+	void parallelFor(int count, int grain, const std::function<void(int begin, int end)> &fn);
+
+	void stop();
+
+private:
+	WorkerPool();
+	~WorkerPool();
+
+	void startThreads();
+
+	void runJobs(Task *task);
+
+	QVector<WorkerPoolThr *> m_threads;
+	QVector<Task *> m_tasks;
+	bool m_br = false;
+
+	QWaitCondition m_taskCond, m_doneCond;
+	QMutex m_mutex;
+};